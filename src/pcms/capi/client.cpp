@@ -52,8 +52,10 @@ void pcms_destroy_reverse_classification(
     delete reinterpret_cast<pcms::ReverseClassificationVertex*>(rc.pointer);
 }
 struct AddFieldVariantOperators {
-  AddFieldVariantOperators(const char* name, pcms::CouplerClient* client, int participates)
-  : name_(name), client_(client), participates_(participates)
+  AddFieldVariantOperators(const char* name, pcms::CouplerClient* client,
+                           int participates, const char* layout_name = "")
+  : name_(name), client_(client), participates_(participates),
+    layout_name_(layout_name)
   {
   }
 
@@ -62,12 +64,14 @@ struct AddFieldVariantOperators {
   template <typename FieldAdapter>
   [[nodiscard]]
   pcms::CoupledField* operator()(const FieldAdapter& field_adapter) const noexcept {
-        return client_->AddField(name_, field_adapter, participates_);
+        return client_->AddField(name_, field_adapter, participates_,
+                                 layout_name_);
   }
 
   const char* name_;
   pcms::CouplerClient* client_;
   bool participates_;
+  const char* layout_name_;
 };
 
 PcmsFieldHandle pcms_add_field(PcmsClientHandle client_handle,
@@ -91,6 +95,22 @@ PcmsFieldHandle pcms_add_field(PcmsClientHandle client_handle,
   pcms::CoupledField* field = std::visit(AddFieldVariantOperators{name, client, participates},*adapter);
   return {reinterpret_cast<void*>(field)};
 }
+PcmsFieldHandle pcms_add_field_with_layout(
+  PcmsClientHandle client_handle, const char* name,
+  PcmsFieldAdapterHandle adapter_handle, int participates,
+  const char* layout_name)
+{
+  auto* adapter =
+    reinterpret_cast<pcms::FieldAdapterVariant*>(adapter_handle.pointer);
+  auto* client = reinterpret_cast<pcms::CouplerClient*>(client_handle.pointer);
+  PCMS_ALWAYS_ASSERT(client != nullptr);
+  PCMS_ALWAYS_ASSERT(adapter != nullptr);
+  PCMS_ALWAYS_ASSERT(layout_name != nullptr);
+  pcms::CoupledField* field = std::visit(
+    AddFieldVariantOperators{name, client, participates, layout_name},
+    *adapter);
+  return {reinterpret_cast<void*>(field)};
+}
 void pcms_send_field_name(PcmsClientHandle client_handle, const char* name)
 {
   auto* client = reinterpret_cast<pcms::CouplerClient*>(client_handle.pointer);
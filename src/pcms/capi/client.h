@@ -65,6 +65,12 @@ PcmsFieldHandle pcms_add_field(PcmsClientHandle client_handle,
                                     const char* name,
                                     PcmsFieldAdapterHandle adapter_handle,
                                     int participates);
+// fields that are defined on the same vertices can share a communication
+// layout. The same layout name must be used for the fields on the server.
+PcmsFieldHandle pcms_add_field_with_layout(
+  PcmsClientHandle client_handle, const char* name,
+  PcmsFieldAdapterHandle adapter_handle, int participates,
+  const char* layout_name);
 void pcms_send_field_name(PcmsClientHandle, const char* name);
 void pcms_receive_field_name(PcmsClientHandle, const char* name);
 
@@ -14,7 +14,8 @@ public:
   template <typename FieldAdapterT>
   CoupledField(const std::string& name, FieldAdapterT field_adapter,
                MPI_Comm mpi_comm, redev::Redev& redev, redev::Channel& channel,
-               bool participates)
+               bool participates, FieldLayoutCache* layout_cache = nullptr,
+               std::string layout_name = "")
   {
     PCMS_FUNCTION_TIMER;
     MPI_Comm mpi_comm_subset = MPI_COMM_NULL;
@@ -29,7 +30,7 @@ public:
     coupled_field_ =
       std::make_unique<CoupledFieldModel<FieldAdapterT, FieldAdapterT>>(
         name, std::move(field_adapter), mpi_comm_subset, redev, channel,
-        participates);
+        participates, layout_cache, std::move(layout_name));
   }
 
   void Send(Mode mode = Mode::Synchronous)
@@ -42,10 +43,40 @@ public:
     PCMS_FUNCTION_TIMER;
     coupled_field_->Receive();
   }
+  /// post the receive and defer deserialization until Complete is called
+  [[nodiscard]] PendingReceive PostReceive(Mode mode = Mode::Deferred)
+  {
+    PCMS_FUNCTION_TIMER;
+    return coupled_field_->PostReceive(mode);
+  }
+  /**
+   * create a communicator that sends/receives this field and the other fields
+   * as a single message. All fields must have the same value type and layout.
+   */
+  [[nodiscard]] FieldGroupCommunicator CreateFieldGroup(
+    std::string name, redev::Channel& channel,
+    const std::vector<CoupledField*>& fields) const
+  {
+    PCMS_FUNCTION_TIMER;
+    std::vector<CoupledFieldConcept*> coupled_fields;
+    coupled_fields.reserve(fields.size());
+    for (const auto* field : fields) {
+      coupled_fields.push_back(field->coupled_field_.get());
+    }
+    return coupled_field_->CreateFieldGroup(std::move(name), channel,
+                                            coupled_fields);
+  }
   struct CoupledFieldConcept
   {
     virtual void Send(Mode) = 0;
     virtual void Receive() = 0;
+    virtual PendingReceive PostReceive(Mode) = 0;
+    // the field communicator as a detail::PackableField<value_type>
+    [[nodiscard]] virtual detail::PackableFieldBase*
+    GetPackableField() noexcept = 0;
+    [[nodiscard]] virtual FieldGroupCommunicator CreateFieldGroup(
+      std::string, redev::Channel&,
+      const std::vector<CoupledFieldConcept*>&) const = 0;
     virtual ~CoupledFieldConcept() = default;
   };
   template <typename FieldAdapterT, typename CommT>
@@ -55,11 +86,13 @@ public:
 
     CoupledFieldModel(const std::string& name, FieldAdapterT&& field_adapter,
                       MPI_Comm mpi_comm_subset, redev::Redev& redev,
-                      redev::Channel& channel, bool participates)
+                      redev::Channel& channel, bool participates,
+                      FieldLayoutCache* layout_cache, std::string layout_name)
       : mpi_comm_subset_(mpi_comm_subset),
         field_adapter_(std::move(field_adapter)),
         comm_(FieldCommunicator<CommT>(name, mpi_comm_subset_, redev, channel,
-                                       field_adapter_))
+                                       field_adapter_, layout_cache,
+                                       std::move(layout_name)))
     {
       PCMS_FUNCTION_TIMER;
     }
@@ -73,6 +106,28 @@ public:
       PCMS_FUNCTION_TIMER;
       comm_.Receive();
     };
+    PendingReceive PostReceive(Mode mode) final
+    {
+      PCMS_FUNCTION_TIMER;
+      return comm_.PostReceive(mode);
+    };
+    [[nodiscard]] detail::PackableFieldBase* GetPackableField() noexcept final
+    {
+      return &comm_;
+    }
+    [[nodiscard]] FieldGroupCommunicator CreateFieldGroup(
+      std::string name, redev::Channel& channel,
+      const std::vector<CoupledFieldConcept*>& fields) const final
+    {
+      PCMS_FUNCTION_TIMER;
+      std::vector<detail::PackableFieldBase*> packable_fields;
+      packable_fields.reserve(fields.size());
+      for (auto* field : fields) {
+        packable_fields.push_back(field->GetPackableField());
+      }
+      return FieldGroupCommunicator::Create<value_type>(
+        std::move(name), channel, packable_fields);
+    }
     ~CoupledFieldModel()
     {
       PCMS_FUNCTION_TIMER;
@@ -102,6 +157,7 @@ public:
     : name_(std::move(name)),
       mpi_comm_(comm),
       redev_(comm),
+      layout_cache_(comm),
       channel_{redev_.CreateAdiosChannel(name_, std::move(params),
                                          transport_type, std::move(path))}
   {
@@ -119,15 +175,20 @@ public:
    * The redev partion has to be same as the partition of the OH mesh.
    * It asserts the number of elements sent and received are same.
    * otherwise, ConstructPermutation() will fail.
+   *
+   * Fields that are defined on the same vertices can provide a shared
+   * layout_name so that only the first of them exchanges GIDs with the server.
+   * The server must add its fields with the same layout names.
   */
   template <typename FieldAdapterT>
   CoupledField* AddField(std::string name, FieldAdapterT field_adapter,
-                         bool participates = true)
+                         bool participates = true,
+                         std::string layout_name = "")
   {
     PCMS_FUNCTION_TIMER;
-    auto [it, inserted] =
-      fields_.template try_emplace(name, name, std::move(field_adapter),
-                                   mpi_comm_, redev_, channel_, participates);
+    auto [it, inserted] = fields_.template try_emplace(
+      name, name, std::move(field_adapter), mpi_comm_, redev_, channel_,
+      participates, &layout_cache_, std::move(layout_name));
     if (!inserted) {
       std::cerr << "OHField with this name" << name << "already exists!\n";
       std::terminate();
@@ -151,6 +212,45 @@ public:
     PCMS_ALWAYS_ASSERT(InReceivePhase());
     detail::find_or_error(name, fields_).Receive();
   };
+  /**
+   * Post a receive for a field without deserializing it. When posted with
+   * Mode::Deferred, call Complete on the returned handle after
+   * EndReceivePhase.
+   */
+  [[nodiscard]] PendingReceive PostReceiveField(const std::string& name,
+                                                Mode mode = Mode::Deferred)
+  {
+    PCMS_FUNCTION_TIMER;
+    PCMS_ALWAYS_ASSERT(InReceivePhase());
+    return detail::find_or_error(name, fields_).PostReceive(mode);
+  }
+  /**
+   * Send a group of fields as a single message. The fields must have the same
+   * value type and share a layout (see AddField). The server must receive the
+   * group with the same field names in the same order.
+   */
+  void SendFields(const std::vector<std::string>& names,
+                  Mode mode = Mode::Synchronous)
+  {
+    PCMS_FUNCTION_TIMER;
+    PCMS_ALWAYS_ASSERT(InSendPhase());
+    GetFieldGroup(names).Send(mode);
+  }
+  /// Receive a group of fields that was sent as a single message
+  void ReceiveFields(const std::vector<std::string>& names)
+  {
+    PCMS_FUNCTION_TIMER;
+    PCMS_ALWAYS_ASSERT(InReceivePhase());
+    GetFieldGroup(names).Receive();
+  }
+  /// Post a receive for a group of fields, see PostReceiveField
+  [[nodiscard]] PendingReceive PostReceiveFields(
+    const std::vector<std::string>& names, Mode mode = Mode::Deferred)
+  {
+    PCMS_FUNCTION_TIMER;
+    PCMS_ALWAYS_ASSERT(InReceivePhase());
+    return GetFieldGroup(names).PostReceive(mode);
+  }
   [[nodiscard]] bool InSendPhase() const noexcept
   {
     PCMS_FUNCTION_TIMER;
@@ -183,13 +283,36 @@ public:
   }
 
 private:
+  FieldGroupCommunicator& GetFieldGroup(const std::vector<std::string>& names)
+  {
+    PCMS_FUNCTION_TIMER;
+    PCMS_ALWAYS_ASSERT(!names.empty());
+    auto group_name = detail::FieldGroupName(names);
+    auto it = field_groups_.find(group_name);
+    if (it == field_groups_.end()) {
+      std::vector<CoupledField*> fields;
+      fields.reserve(names.size());
+      for (const auto& name : names) {
+        fields.push_back(&detail::find_or_error(name, fields_));
+      }
+      auto group =
+        fields.front()->CreateFieldGroup(group_name, channel_, fields);
+      it = field_groups_.emplace(std::move(group_name), std::move(group)).first;
+    }
+    return it->second;
+  }
+
   std::string name_;
   MPI_Comm mpi_comm_;
   redev::Redev redev_;
+  // layouts must outlive the fields that refer to them
+  FieldLayoutCache layout_cache_;
   // map rather than unordered_map is necessary to avoid iterator invalidation.
   // This is important because we pass pointers to the fields out of this class
   std::map<std::string, CoupledField> fields_;
   redev::Channel channel_;
+  // field groups hold pointers to the fields, so they are declared after them
+  std::map<std::string, FieldGroupCommunicator> field_groups_;
 };
 } // namespace pcms
 
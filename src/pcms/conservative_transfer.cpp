@@ -0,0 +1,258 @@
+#include "pcms/conservative_transfer.h"
+#include "pcms/assert.h"
+#include "pcms/profile.h"
+#include <algorithm>
+#include <cmath>
+#include <utility>
+#include <vector>
+
+namespace pcms
+{
+namespace detail
+{
+namespace
+{
+Real cross(const Omega_h::Vector<2>& a, const Omega_h::Vector<2>& b)
+{
+  return a[0] * b[1] - a[1] * b[0];
+}
+
+// Sutherland-Hodgman clip of the convex polygon against the half plane to the
+// inside (given by orientation) of the directed edge from a to b
+int clip_polygon(const std::array<Omega_h::Vector<2>, 8>& in, int n,
+                 const Omega_h::Vector<2>& a, const Omega_h::Vector<2>& b,
+                 Real orientation, std::array<Omega_h::Vector<2>, 8>& out)
+{
+  const auto edge = b - a;
+  int m = 0;
+  for (int i = 0; i < n; ++i) {
+    const auto& current = in[i];
+    const auto& previous = in[(i + n - 1) % n];
+    const Real d_current = orientation * cross(edge, current - a);
+    const Real d_previous = orientation * cross(edge, previous - a);
+    if (d_current >= 0) {
+      if (d_previous < 0) {
+        const Real t = d_previous / (d_previous - d_current);
+        out[m++] = previous + (current - previous) * t;
+      }
+      out[m++] = current;
+    } else if (d_previous >= 0) {
+      const Real t = d_previous / (d_previous - d_current);
+      out[m++] = previous + (current - previous) * t;
+    }
+  }
+  return m;
+}
+
+std::array<LO, 3> gather_host_verts(const Omega_h::HostRead<LO>& tris2verts,
+                                    LO elem_idx)
+{
+  return {tris2verts[3 * elem_idx], tris2verts[3 * elem_idx + 1],
+          tris2verts[3 * elem_idx + 2]};
+}
+
+Omega_h::Matrix<2, 3> gather_host_coords(
+  const Omega_h::HostRead<Real>& coords, const std::array<LO, 3>& verts)
+{
+  Omega_h::Matrix<2, 3> vertex_coords;
+  for (int i = 0; i < 3; ++i) {
+    vertex_coords(0, i) = coords[2 * verts[i]];
+    vertex_coords(1, i) = coords[2 * verts[i] + 1];
+  }
+  return vertex_coords;
+}
+} // namespace
+
+int intersect_triangles(const Omega_h::Matrix<2, 3>& subject,
+                        const Omega_h::Matrix<2, 3>& clip,
+                        std::array<Omega_h::Vector<2>, 8>& polygon)
+{
+  const Real orientation =
+    (cross(clip[1] - clip[0], clip[2] - clip[0]) < 0) ? -1 : 1;
+  std::array<Omega_h::Vector<2>, 8> buffer;
+  for (int i = 0; i < 3; ++i) {
+    polygon[i] = subject[i];
+  }
+  int n = 3;
+  for (int i = 0; i < 3 && n > 0; ++i) {
+    n = clip_polygon(polygon, n, clip[i], clip[(i + 1) % 3], orientation,
+                     buffer);
+    std::swap(polygon, buffer);
+  }
+  return n;
+}
+
+Real triangle_intersection_area(const Omega_h::Matrix<2, 3>& a,
+                                const Omega_h::Matrix<2, 3>& b)
+{
+  std::array<Omega_h::Vector<2>, 8> polygon;
+  const int n = intersect_triangles(a, b, polygon);
+  Real area = 0;
+  for (int k = 1; k + 1 < n; ++k) {
+    area += cross(polygon[k] - polygon[0], polygon[k + 1] - polygon[0]) / 2;
+  }
+  return std::abs(area);
+}
+} // namespace detail
+
+InterpolationOperator<Kokkos::DefaultExecutionSpace::memory_space>
+build_conservative_operator(Omega_h::Mesh& source_mesh,
+                            const GridPointSearch& source_search,
+                            Omega_h::Mesh& target_mesh,
+                            const Omega_h::Read<LO>& target_mask,
+                            LO target_size)
+{
+  PCMS_FUNCTION_TIMER;
+  using memory_space = Kokkos::DefaultExecutionSpace::memory_space;
+  const Omega_h::HostRead<Real> source_coords(source_mesh.coords());
+  const Omega_h::HostRead<LO> source_tris2verts(source_mesh.ask_elem_verts());
+  const Omega_h::HostRead<Real> target_coords(target_mesh.coords());
+  const Omega_h::HostRead<LO> target_tris2verts(target_mesh.ask_elem_verts());
+  const auto& candidate_map = source_search.GetCandidateMap();
+  const auto row_map = Kokkos::create_mirror_view_and_copy(
+    Kokkos::HostSpace{}, candidate_map.row_map);
+  const auto entries = Kokkos::create_mirror_view_and_copy(
+    Kokkos::HostSpace{}, candidate_map.entries);
+  const auto grid_h = Kokkos::create_mirror_view_and_copy(
+    Kokkos::HostSpace{}, source_search.GetGrid());
+  const auto& grid = grid_h(0);
+
+  // entries of the mixed mass matrix for each target vertex
+  std::vector<std::vector<std::pair<LO, Real>>> mass(target_mesh.nverts());
+  std::vector<LO> candidates;
+  std::array<Omega_h::Vector<2>, 8> polygon;
+  for (LO target_elem = 0; target_elem < target_mesh.nelems(); ++target_elem) {
+    const auto target_verts =
+      detail::gather_host_verts(target_tris2verts, target_elem);
+    const auto target_tri =
+      detail::gather_host_coords(target_coords, target_verts);
+    Omega_h::Vector<2> lower{target_tri(0, 0), target_tri(1, 0)};
+    Omega_h::Vector<2> upper = lower;
+    for (int i = 1; i < 3; ++i) {
+      for (int d = 0; d < 2; ++d) {
+        lower[d] = std::min(lower[d], target_tri(d, i));
+        upper[d] = std::max(upper[d], target_tri(d, i));
+      }
+    }
+    const AABBox<2> bbox{
+      .center = {(upper[0] + lower[0]) / 2, (upper[1] + lower[1]) / 2},
+      .half_width = {(upper[0] - lower[0]) / 2, (upper[1] - lower[1]) / 2}};
+    const auto [row_begin, col_begin] = grid.ClosestTwoDCellIndex(lower);
+    const auto [row_end, col_end] = grid.ClosestTwoDCellIndex(upper);
+    candidates.clear();
+    for (LO row = row_begin; row <= row_end; ++row) {
+      for (LO col = col_begin; col <= col_end; ++col) {
+        const auto cell_id = grid.GetCellIndex(row, col);
+        for (LO k = row_map(cell_id); k < row_map(cell_id + 1); ++k) {
+          candidates.push_back(entries(k));
+        }
+      }
+    }
+    std::sort(candidates.begin(), candidates.end());
+    candidates.erase(std::unique(candidates.begin(), candidates.end()),
+                     candidates.end());
+    for (const auto source_elem : candidates) {
+      const auto source_verts =
+        detail::gather_host_verts(source_tris2verts, source_elem);
+      const auto source_tri =
+        detail::gather_host_coords(source_coords, source_verts);
+      if (!triangle_intersects_bbox(source_tri, bbox)) {
+        continue;
+      }
+      const int n =
+        detail::intersect_triangles(source_tri, target_tri, polygon);
+      // the edge midpoint rule on each triangle of the fan is exact for the
+      // quadratic integrand
+      Real local_mass[3][3] = {};
+      for (int k = 1; k + 1 < n; ++k) {
+        const auto& p0 = polygon[0];
+        const auto& p1 = polygon[k];
+        const auto& p2 = polygon[k + 1];
+        const Real area = std::abs(detail::cross(p1 - p0, p2 - p0)) / 2;
+        if (area <= 0) {
+          continue;
+        }
+        for (const auto& q : {(p0 + p1) / 2, (p1 + p2) / 2, (p2 + p0) / 2}) {
+          const auto phi_target = barycentric_from_global(q, target_tri);
+          const auto phi_source = barycentric_from_global(q, source_tri);
+          for (int i = 0; i < 3; ++i) {
+            for (int j = 0; j < 3; ++j) {
+              local_mass[i][j] += area / 3 * phi_target[i] * phi_source[j];
+            }
+          }
+        }
+      }
+      for (int i = 0; i < 3; ++i) {
+        for (int j = 0; j < 3; ++j) {
+          if (local_mass[i][j] != 0) {
+            mass[target_verts[i]].emplace_back(source_verts[j],
+                                               local_mass[i][j]);
+          }
+        }
+      }
+    }
+  }
+
+  // assemble the rows of the target field vertices
+  const LO target_nverts = target_mesh.nverts();
+  std::vector<LO> field_verts(target_size, -1);
+  if (target_mask.exists()) {
+    const Omega_h::HostRead<LO> mask(target_mask);
+    PCMS_ALWAYS_ASSERT(mask.size() == target_nverts);
+    for (LO v = 0; v < target_nverts; ++v) {
+      if (mask[v] > 0) {
+        field_verts[mask[v] - 1] = v;
+      }
+    }
+  } else {
+    PCMS_ALWAYS_ASSERT(target_size == target_nverts);
+    for (LO v = 0; v < target_nverts; ++v) {
+      field_verts[v] = v;
+    }
+  }
+  Kokkos::View<LO*, memory_space> row_offsets("row_offsets", target_size + 1);
+  auto row_offsets_h = Kokkos::create_mirror_view(row_offsets);
+  std::vector<LO> columns_h;
+  std::vector<Real> weights_h;
+  row_offsets_h(0) = 0;
+  for (LO i = 0; i < target_size; ++i) {
+    auto& row = mass[field_verts[i]];
+    std::sort(row.begin(), row.end(),
+              [](const auto& a, const auto& b) { return a.first < b.first; });
+    const auto row_begin = columns_h.size();
+    Real row_sum = 0;
+    for (const auto& [column, value] : row) {
+      if (columns_h.size() > row_begin && columns_h.back() == column) {
+        weights_h.back() += value;
+      } else {
+        columns_h.push_back(column);
+        weights_h.push_back(value);
+      }
+      row_sum += value;
+    }
+    // target vertices that don't overlap the source mesh get zero
+    if (row_sum > 0) {
+      for (auto j = row_begin; j < weights_h.size(); ++j) {
+        weights_h[j] /= row_sum;
+      }
+    } else {
+      columns_h.resize(row_begin);
+      weights_h.resize(row_begin);
+    }
+    row_offsets_h(i + 1) = static_cast<LO>(columns_h.size());
+  }
+  Kokkos::deep_copy(row_offsets, row_offsets_h);
+  Kokkos::View<LO*, memory_space> columns("columns", columns_h.size());
+  Kokkos::View<Real*, memory_space> weights("weights", weights_h.size());
+  Kokkos::deep_copy(
+    columns, Kokkos::View<LO*, Kokkos::HostSpace,
+                          Kokkos::MemoryTraits<Kokkos::Unmanaged>>(
+               columns_h.data(), columns_h.size()));
+  Kokkos::deep_copy(
+    weights, Kokkos::View<Real*, Kokkos::HostSpace,
+                          Kokkos::MemoryTraits<Kokkos::Unmanaged>>(
+               weights_h.data(), weights_h.size()));
+  return {row_offsets, columns, weights};
+}
+
+} // namespace pcms
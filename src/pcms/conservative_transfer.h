@@ -0,0 +1,47 @@
+#ifndef PCMS_COUPLING_CONSERVATIVE_TRANSFER_H
+#define PCMS_COUPLING_CONSERVATIVE_TRANSFER_H
+#include "pcms/interpolation_operator.h"
+#include "pcms/point_search.h"
+#include "pcms/types.h"
+#include <Kokkos_Core.hpp>
+#include <Omega_h_mesh.hpp>
+#include <array>
+
+namespace pcms
+{
+
+/**
+ * Builds the operator for a conservative transfer of a linear (vertex) field
+ * from the source mesh to the target mesh. The source and target triangles
+ * are intersected (the supermesh) and the mixed mass matrix
+ * M_ij = \int phi^target_i phi^source_j is integrated exactly over the
+ * intersections. Each row is divided by its sum (the lumped target mass),
+ * so constant fields are reproduced and the integral of the target field
+ * equals the integral of the source field over the overlap of the meshes.
+ *
+ * Candidate source triangles of each target triangle are found with the
+ * candidate map of the source search. Rows correspond to the target vertices
+ * selected by the mask (all vertices if the mask is empty) and columns to the
+ * source mesh vertices.
+ */
+[[nodiscard]] InterpolationOperator<Kokkos::DefaultExecutionSpace::memory_space>
+build_conservative_operator(Omega_h::Mesh& source_mesh,
+                            const GridPointSearch& source_search,
+                            Omega_h::Mesh& target_mesh,
+                            const Omega_h::Read<LO>& target_mask,
+                            LO target_size);
+
+namespace detail
+{
+/// Intersection of two triangles as a convex polygon with at most 6 vertices.
+/// Returns the number of polygon vertices.
+int intersect_triangles(const Omega_h::Matrix<2, 3>& subject,
+                        const Omega_h::Matrix<2, 3>& clip,
+                        std::array<Omega_h::Vector<2>, 8>& polygon);
+[[nodiscard]] Real triangle_intersection_area(const Omega_h::Matrix<2, 3>& a,
+                                              const Omega_h::Matrix<2, 3>& b);
+} // namespace detail
+
+} // namespace pcms
+
+#endif // PCMS_COUPLING_CONSERVATIVE_TRANSFER_H
@@ -4,7 +4,11 @@
 #include "pcms/types.h"
 #include "pcms/arrays.h"
 #include "pcms/memory_spaces.h"
+#include "pcms/assert.h"
+#include "pcms/profile.h"
 #include <map>
+#include <vector>
+#include <algorithm>
 #include <redev.h>
 #include "pcms/field_evaluation_methods.h"
 #include <any>
@@ -33,6 +37,78 @@ struct HasCoordinateSystem<T, VoidT<typename T::coordinate_system>>
  */
 using ReversePartitionMap = std::map<pcms::LO, std::vector<pcms::LO>>;
 
+/**
+ * Reverse partition in compressed row form. ranks are the ranks on the
+ * coupling server that data is sent to in increasing order, and
+ * indices[offsets[r]], ..., indices[offsets[r+1]-1] are the local indices
+ * (ordered) sent to ranks[r].
+ */
+struct ReversePartition
+{
+  std::vector<pcms::LO> ranks;
+  std::vector<pcms::LO> offsets;
+  std::vector<pcms::LO> indices;
+};
+
+/**
+ * Groups the local indices by destination rank with a counting sort. The
+ * counts are indexed by rank, so this is meant for the rank numbers of the
+ * coupling server.
+ * @param index_ranks the rank that each local index is sent to
+ */
+inline ReversePartition MakeReversePartition(
+  const std::vector<pcms::LO>& index_ranks)
+{
+  PCMS_FUNCTION_TIMER;
+  ReversePartition reverse_partition;
+  if (index_ranks.empty()) {
+    reverse_partition.offsets.push_back(0);
+    return reverse_partition;
+  }
+  const auto max_rank =
+    *std::max_element(index_ranks.begin(), index_ranks.end());
+  std::vector<pcms::LO> position(max_rank + 1, 0);
+  for (const auto rank : index_ranks) {
+    PCMS_ALWAYS_ASSERT(rank >= 0);
+    ++position[rank];
+  }
+  reverse_partition.offsets.push_back(0);
+  pcms::LO offset = 0;
+  for (pcms::LO rank = 0; rank <= max_rank; ++rank) {
+    const auto count = position[rank];
+    position[rank] = offset;
+    if (count > 0) {
+      offset += count;
+      reverse_partition.ranks.push_back(rank);
+      reverse_partition.offsets.push_back(offset);
+    }
+  }
+  // visiting the indices in order keeps each rank's indices ordered
+  const pcms::LO num_indices = index_ranks.size();
+  reverse_partition.indices.resize(num_indices);
+  for (pcms::LO i = 0; i < num_indices; ++i) {
+    reverse_partition.indices[position[index_ranks[i]]++] = i;
+  }
+  return reverse_partition;
+}
+
+inline ReversePartition MakeReversePartition(
+  const ReversePartitionMap& reverse_partition_map)
+{
+  PCMS_FUNCTION_TIMER;
+  ReversePartition reverse_partition;
+  reverse_partition.ranks.reserve(reverse_partition_map.size());
+  reverse_partition.offsets.reserve(reverse_partition_map.size() + 1);
+  reverse_partition.offsets.push_back(0);
+  for (const auto& [rank, indices] : reverse_partition_map) {
+    reverse_partition.ranks.push_back(rank);
+    reverse_partition.indices.insert(reverse_partition.indices.end(),
+                                     indices.begin(), indices.end());
+    reverse_partition.offsets.push_back(reverse_partition.indices.size());
+  }
+  return reverse_partition;
+}
+
 // This is a model interface. The current pcms design does not require that
 // the FieldAdapter must be inherited from this class
 /*
@@ -54,6 +130,9 @@ public:
   virtual std::vector<GO> GetGids() const = 0;
   virtual ReversePartitionMap GetReversePartitionMap(
     const redev::Partition& partition) const = 0;
+  // OPTIONAL. Used instead of GetReversePartitionMap when it is provided
+  virtual ReversePartition GetReversePartition(
+    const redev::Partition& partition) const = 0;
 };
 */
 } // namespace pcms
@@ -3,8 +3,14 @@
 #include <redev.h>
 #include "pcms/field.h"
 #include <numeric>
+#include <memory>
+#include <functional>
+#include <type_traits>
+#include <utility>
 #include "pcms/inclusive_scan.h"
 #include "pcms/profile.h"
+#include <Kokkos_Core.hpp>
+#include <Kokkos_UnorderedMap.hpp>
 namespace pcms
 {
 
@@ -19,7 +25,8 @@ struct OutMsg
 // reverse partition is a map that has the partition rank as a key
 // and the values are an vector where each entry is the index into
 // the array of data to send
-OutMsg ConstructOutMessage(const ReversePartitionMap& reverse_partition)
+inline OutMsg ConstructOutMessage(
+  const ReversePartitionMap& reverse_partition)
 {
   PCMS_FUNCTION_TIMER;
   OutMsg out;
@@ -38,7 +45,12 @@ OutMsg ConstructOutMessage(const ReversePartitionMap& reverse_partition)
                          std::next(out.offset.begin(), 1));
   return out;
 }
-size_t count_entries(const ReversePartitionMap& reverse_partition)
+inline OutMsg ConstructOutMessage(const ReversePartition& reverse_partition)
+{
+  PCMS_FUNCTION_TIMER;
+  return {reverse_partition.ranks, reverse_partition.offsets};
+}
+inline size_t count_entries(const ReversePartitionMap& reverse_partition)
 {
   PCMS_FUNCTION_TIMER;
   size_t num_entries = 0;
@@ -48,7 +60,8 @@ size_t count_entries(const ReversePartitionMap& reverse_partition)
   return num_entries;
 }
 // note this function can be parallelized by making use of the offsets
-redev::LOs ConstructPermutation(const ReversePartitionMap& reverse_partition)
+inline redev::LOs ConstructPermutation(
+  const ReversePartitionMap& reverse_partition)
 {
   PCMS_FUNCTION_TIMER;
   auto num_entries = count_entries(reverse_partition);
@@ -62,40 +75,125 @@ redev::LOs ConstructPermutation(const ReversePartitionMap& reverse_partition)
   }
   return permutation;
 }
+// entry i of the local data goes to position permutation[i] of the message
+inline redev::LOs ConstructPermutation(
+  const ReversePartition& reverse_partition)
+{
+  PCMS_FUNCTION_TIMER;
+  const LO num_entries = reverse_partition.indices.size();
+  redev::LOs permutation(num_entries);
+  for (LO entry = 0; entry < num_entries; ++entry) {
+    const auto idx = reverse_partition.indices[entry];
+    PCMS_ALWAYS_ASSERT(idx >= 0 && idx < num_entries);
+    permutation[idx] = entry;
+  }
+  return permutation;
+}
+template <typename FieldAdapterT, typename = void>
+struct HasReversePartition : std::false_type
+{};
+template <typename FieldAdapterT>
+struct HasReversePartition<
+  FieldAdapterT,
+  VoidT<decltype(std::declval<const FieldAdapterT&>().GetReversePartition(
+    std::declval<const redev::Partition&>()))>> : std::true_type
+{};
+// uses the compressed reverse partition of the field adapter if it provides
+// one, otherwise converts its reverse partition map
+template <typename FieldAdapterT>
+ReversePartition GetReversePartition(const FieldAdapterT& field_adapter,
+                                     const redev::Partition& partition)
+{
+  PCMS_FUNCTION_TIMER;
+  if constexpr (HasReversePartition<FieldAdapterT>::value) {
+    return field_adapter.GetReversePartition(partition);
+  } else {
+    return MakeReversePartition(
+      field_adapter.GetReversePartitionMap(partition));
+  }
+}
 /**
+ * Permutation from the order of the incoming message to the local mesh
+ * iteration order, built in parallel in the execution space of MemorySpace.
+ * The local gids are inserted into a hash map, then each received gid is
+ * looked up and its local index is marked as taken. That single pass also
+ * verifies that the received gids are a permutation of the local gids:
+ * duplicate local gids, received gids that are missing locally and duplicate
+ * received gids all abort.
  *
  * @param local_gids local gids are the mesh GIDs in local mesh iteration order
- * @param received_gids received GIDs are the GIDS in the order of the incomming
- * message1
+ * @param received_gids received GIDs are the GIDS in the order of the incoming
+ * message
  * @return permutation array such that GIDS(Permutation[i]) = msgs
  */
-redev::LOs ConstructPermutation(const std::vector<pcms::GO>& local_gids,
-                                const std::vector<pcms::GO>& received_gids)
+template <typename MemorySpace>
+Kokkos::View<LO*, MemorySpace> ConstructPermutation(
+  Kokkos::View<const GO*, MemorySpace> local_gids,
+  Kokkos::View<const GO*, MemorySpace> received_gids)
 {
   PCMS_FUNCTION_TIMER;
-
-  if(local_gids.size() != received_gids.size()) {
-  std::stringstream ss;
-  ss <<" :local_gids.size() [" << local_gids.size() << "] does not match received_gids.size() [" << received_gids.size() << "]\n";
-  std::cerr<<ss.str();
-  std::abort();
+  using execution_space = typename MemorySpace::execution_space;
+  using device_type = Kokkos::Device<execution_space, MemorySpace>;
+  if (local_gids.size() != received_gids.size()) {
+    std::cerr << "local_gids.size() [" << local_gids.size()
+              << "] does not match received_gids.size() ["
+              << received_gids.size() << "]\n";
+    std::abort();
   }
-
-  REDEV_ALWAYS_ASSERT(local_gids.size() == received_gids.size());
-  REDEV_ALWAYS_ASSERT(std::is_permutation(local_gids.begin(), local_gids.end(), received_gids.begin()));
-  std::map<pcms::GO, pcms::LO> global_to_local_ids;
-  for (size_t i = 0; i < local_gids.size(); ++i) {
-    global_to_local_ids[local_gids[i]] = i;
+  const LO n = local_gids.size();
+  Kokkos::UnorderedMap<GO, LO, device_type> global_to_local_ids(n);
+  LO num_duplicate_local = 0;
+  Kokkos::parallel_reduce(
+    Kokkos::RangePolicy<execution_space>(0, n),
+    KOKKOS_LAMBDA(LO i, LO & errors) {
+      const auto result = global_to_local_ids.insert(local_gids(i), i);
+      errors += (result.existing() || result.failed());
+    },
+    num_duplicate_local);
+  if (num_duplicate_local > 0) {
+    std::cerr << num_duplicate_local << " local gids are duplicated\n";
+    std::abort();
   }
-  redev::LOs permutation;
-  permutation.reserve(local_gids.size());
-  for (auto gid : received_gids) {
-    permutation.push_back(global_to_local_ids[gid]);
+  Kokkos::View<LO*, MemorySpace> permutation("permutation", n);
+  Kokkos::View<LO*, MemorySpace> taken("taken", n);
+  LO num_invalid = 0;
+  Kokkos::parallel_reduce(
+    Kokkos::RangePolicy<execution_space>(0, n),
+    KOKKOS_LAMBDA(LO i, LO & errors) {
+      const auto entry = global_to_local_ids.find(received_gids(i));
+      if (!global_to_local_ids.valid_at(entry)) {
+        ++errors;
+        return;
+      }
+      const LO local = global_to_local_ids.value_at(entry);
+      permutation(i) = local;
+      // duplicate data indicates that the sender is not sending data from
+      // only the owned rank
+      errors += (Kokkos::atomic_fetch_add(&taken(local), 1) > 0);
+    },
+    num_invalid);
+  if (num_invalid > 0) {
+    std::cerr << "received gids are not a permutation of the local gids: "
+              << num_invalid << " gids are missing locally or duplicated\n";
+    std::abort();
   }
   return permutation;
 }
-OutMsg ConstructOutMessage(int rank, int nproc,
-                           const redev::InMessageLayout& in)
+/// host version of the parallel permutation construction
+inline redev::LOs ConstructPermutation(
+  const std::vector<pcms::GO>& local_gids,
+  const std::vector<pcms::GO>& received_gids)
+{
+  PCMS_FUNCTION_TIMER;
+  using GidView = Kokkos::View<const GO*, HostMemorySpace,
+                               Kokkos::MemoryTraits<Kokkos::Unmanaged>>;
+  const auto permutation = ConstructPermutation<HostMemorySpace>(
+    GidView(local_gids.data(), local_gids.size()),
+    GidView(received_gids.data(), received_gids.size()));
+  return {permutation.data(), permutation.data() + permutation.size()};
+}
+inline OutMsg ConstructOutMessage(int rank, int nproc,
+                                  const redev::InMessageLayout& in)
 {
   PCMS_FUNCTION_TIMER;
   REDEV_ALWAYS_ASSERT(!in.srcRanks.empty());
@@ -128,41 +226,278 @@ OutMsg ConstructOutMessage(int rank, int nproc,
   return out;
 }
 
-template <typename T>
-bool HasDuplicates(std::vector<T> v)
+/**
+ * Communication layout of a field. The layout only depends on the vertices
+ * the field is defined on (adapter geometry and overlap mask), so it can be
+ * shared by every field that is defined on the same vertex set.
+ */
+struct FieldLayout
+{
+  OutMsg out_message;
+  redev::LOs message_permutation;
+  // number and hash of the gids the layout was constructed from. Used to
+  // verify that a field that reuses the layout has the same vertex set
+  size_t num_gids{0};
+  size_t gid_hash{0};
+  // false for the empty layout of a rank that does not communicate the field
+  bool participates{false};
+};
+
+inline size_t HashGids(const std::vector<GO>& gids)
 {
   PCMS_FUNCTION_TIMER;
-  std::sort(v.begin(), v.end());
-  auto it = std::adjacent_find(v.begin(), v.end());
-  return it != v.end();
+  size_t seed = gids.size();
+  for (auto gid : gids) {
+    // hash combine from boost
+    seed ^= std::hash<GO>{}(gid) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+  }
+  return seed;
+}
+// true if the layout was constructed from the same gids in the same order
+inline bool LayoutMatchesGids(const FieldLayout& layout,
+                              const std::vector<GO>& gids)
+{
+  PCMS_FUNCTION_TIMER;
+  return gids.size() == layout.num_gids && HashGids(gids) == layout.gid_hash;
 }
 } // namespace detail
 
+/**
+ * Cache of field communication layouts that is shared by all fields on a
+ * channel. Fields that are added with the same layout name share a single GID
+ * exchange and a single permutation array.
+ * @WARNING the same layout names must be used on the client and the server
+ */
+class FieldLayoutCache
+{
+public:
+  FieldLayoutCache() = default;
+  /**
+   * @param comm all ranks that add fields to the channel. Lookups are
+   * collective on comm so that the ranks agree on whether the GIDs are
+   * exchanged.
+   */
+  explicit FieldLayoutCache(MPI_Comm comm) : comm_(comm) {}
+  /**
+   * Returns the layout cached under the name if it was constructed with the
+   * same participation as the caller's. A rank that did not communicate the
+   * first field with a layout name can therefore still communicate a later
+   * one. If any rank of the comm does not find a matching layout, nullptr is
+   * returned on every rank and the layout must be constructed (and inserted)
+   * again on all ranks.
+   */
+  [[nodiscard]] std::shared_ptr<const detail::FieldLayout> Find(
+    const std::string& layout_name, bool participates) const
+  {
+    PCMS_FUNCTION_TIMER;
+    auto it = layouts_.find(layout_name);
+    int found = (it != layouts_.end() &&
+                 it->second->participates == participates);
+    if (comm_ != MPI_COMM_NULL) {
+      MPI_Allreduce(MPI_IN_PLACE, &found, 1, MPI_INT, MPI_LAND, comm_);
+    }
+    if (!found) {
+      return nullptr;
+    }
+    return it->second;
+  }
+  /// cache the layout under the name. Replaces a previously cached layout
+  void Insert(const std::string& layout_name,
+              std::shared_ptr<const detail::FieldLayout> layout)
+  {
+    PCMS_FUNCTION_TIMER;
+    PCMS_ALWAYS_ASSERT(layout != nullptr);
+    layouts_.insert_or_assign(layout_name, std::move(layout));
+  }
+  [[nodiscard]] size_t Size() const noexcept { return layouts_.size(); }
+
+private:
+  MPI_Comm comm_ = MPI_COMM_NULL;
+  std::map<std::string, std::shared_ptr<const detail::FieldLayout>> layouts_;
+};
+
 using redev::Mode;
 
+/**
+ * Handle to a posted receive. The received data is only deserialized into the
+ * field when Complete is called. For receives posted with Mode::Deferred,
+ * Complete must be called after the receive communication phase has ended.
+ * The handle must not outlive the communicator that created it, and it must
+ * be completed before the next receive is posted on the same field.
+ */
+class PendingReceive
+{
+public:
+  /// a receive that is already complete
+  PendingReceive() = default;
+  explicit PendingReceive(std::function<void()> complete)
+    : complete_(std::move(complete))
+  {
+  }
+  /// deserialize the received data. Calling Complete more than once is a no-op
+  void Complete()
+  {
+    PCMS_FUNCTION_TIMER;
+    if (complete_) {
+      auto complete = std::move(complete_);
+      complete_ = nullptr;
+      complete();
+    }
+  }
+  [[nodiscard]] bool IsComplete() const noexcept { return !complete_; }
+
+private:
+  std::function<void()> complete_;
+};
+
+namespace detail
+{
+/**
+ * Type erased PackableField. The value type of a field is recovered with
+ * dynamic_cast when fields are grouped.
+ */
+struct PackableFieldBase
+{
+  virtual ~PackableFieldBase() = default;
+};
+/**
+ * Interface that lets a FieldGroupCommunicator pack the serialized data of
+ * several fields with the same value type into a single message
+ */
+template <typename T>
+struct PackableField : public PackableFieldBase
+{
+  [[nodiscard]] virtual std::shared_ptr<const FieldLayout> GetLayout()
+    const noexcept = 0;
+  [[nodiscard]] virtual MPI_Comm GetMPIComm() const noexcept = 0;
+  /// serialize the field into message order and return a view of the result
+  [[nodiscard]] virtual ScalarArrayView<const T, HostMemorySpace> Pack() = 0;
+  /// deserialize the field from data that is in message order
+  virtual void Unpack(ScalarArrayView<const T, HostMemorySpace> data) = 0;
+};
+
+/**
+ * Converts the type erased fields of a group to fields with value type T.
+ * Aborts if a field does not communicate or has a different value type.
+ */
+template <typename T>
+std::vector<PackableField<T>*> CastPackableFields(
+  const std::string& group_name, const std::vector<PackableFieldBase*>& fields)
+{
+  PCMS_FUNCTION_TIMER;
+  std::vector<PackableField<T>*> packable_fields;
+  packable_fields.reserve(fields.size());
+  for (auto* field : fields) {
+    if (field == nullptr) {
+      std::cerr << "Field in field group " << group_name
+                << " does not have a field communicator\n";
+      std::abort();
+    }
+    auto* packable = dynamic_cast<PackableField<T>*>(field);
+    if (packable == nullptr) {
+      std::cerr << "All fields in field group " << group_name
+                << " must have the same value type\n";
+      std::abort();
+    }
+    packable_fields.push_back(packable);
+  }
+  return packable_fields;
+}
+
+// the fields of a group share the message (dest/offset) layout. The
+// permutations may differ since each field serializes into message order
+// itself
+inline bool HaveSameMessageLayout(const FieldLayout& a, const FieldLayout& b)
+{
+  PCMS_FUNCTION_TIMER;
+  return a.out_message.dest == b.out_message.dest &&
+         a.out_message.offset == b.out_message.offset;
+}
+
+// message layout of a group with num_fields interleaved fields
+inline OutMsg ScaleOutMessage(OutMsg out_message, LO num_fields)
+{
+  PCMS_FUNCTION_TIMER;
+  for (auto& offset : out_message.offset) {
+    offset *= num_fields;
+  }
+  return out_message;
+}
+
+/**
+ * Packs the fields into buffer so that buffer[i*num_fields+j] is entry i of
+ * field j in message order
+ */
+template <typename T>
+void PackFields(const std::vector<PackableField<T>*>& fields,
+                std::vector<T>& buffer)
+{
+  PCMS_FUNCTION_TIMER;
+  const auto num_fields = fields.size();
+  for (size_t j = 0; j < num_fields; ++j) {
+    const auto data = fields[j]->Pack();
+    REDEV_ALWAYS_ASSERT(data.size() * num_fields == buffer.size());
+    for (size_t i = 0; i < data.size(); ++i) {
+      buffer[i * num_fields + j] = data[i];
+    }
+  }
+}
+
+/// inverse of PackFields. scratch holds the data of one field at a time
+template <typename T>
+void UnpackFields(const std::vector<T>& buffer,
+                  const std::vector<PackableField<T>*>& fields,
+                  std::vector<T>& scratch)
+{
+  PCMS_FUNCTION_TIMER;
+  const auto num_fields = fields.size();
+  REDEV_ALWAYS_ASSERT(buffer.size() % num_fields == 0);
+  scratch.resize(buffer.size() / num_fields);
+  for (size_t j = 0; j < num_fields; ++j) {
+    for (size_t i = 0; i < scratch.size(); ++i) {
+      scratch[i] = buffer[i * num_fields + j];
+    }
+    fields[j]->Unpack(make_const_array_view(scratch));
+  }
+}
+} // namespace detail
+
 // TODO refactor to take application rather than channel
 template <typename FieldAdapterT>
 struct FieldCommunicator
+  : public detail::PackableField<typename FieldAdapterT::value_type>
 {
   using T = typename FieldAdapterT::value_type;
 
 public:
+  /**
+   * @param layout_cache cache of layouts on the channel. If a layout_name is
+   * provided, fields with the same layout name share their communication
+   * layout and only the first of them exchanges GIDs.
+   */
   FieldCommunicator(std::string name, MPI_Comm mpi_comm, redev::Redev& redev,
                     redev::Channel& channel,
-                    FieldAdapterT& field_adapter)
+                    FieldAdapterT& field_adapter,
+                    FieldLayoutCache* layout_cache = nullptr,
+                    std::string layout_name = "")
     : mpi_comm_(mpi_comm),
       channel_(channel),
       comm_buffer_{},
-      message_permutation_{},
+      layout_{},
       buffer_size_needs_update_{true},
       field_adapter_(field_adapter),
       name_{std::move(name)},
-      redev_(redev)
+      redev_(redev),
+      layout_cache_(layout_cache),
+      layout_name_(std::move(layout_name))
   {
     PCMS_FUNCTION_TIMER;
     comm_ = channel.CreateComm<T>(name_, mpi_comm_);
     gid_comm_ = channel.CreateComm<GO>(name_ + "_gids", mpi_comm_);
-    if(mpi_comm != MPI_COMM_NULL) {
+    if (auto cached_layout = FindCachedLayout(); cached_layout != nullptr) {
+      UseLayout(std::move(cached_layout));
+    }
+    else if(mpi_comm != MPI_COMM_NULL) {
       UpdateLayout();
     }
     else {
@@ -170,38 +505,83 @@ public:
     }
   }
 
+  // pending receives and field groups refer to the communicator by address,
+  // so it is constructed in place and never moved
   FieldCommunicator(const FieldCommunicator&) = delete;
-  FieldCommunicator(FieldCommunicator&&) = default;
+  FieldCommunicator(FieldCommunicator&&) = delete;
   FieldCommunicator& operator=(const FieldCommunicator&) = delete;
-  FieldCommunicator& operator=(FieldCommunicator&&) = default;
+  FieldCommunicator& operator=(FieldCommunicator&&) = delete;
 
   void Send(Mode mode = Mode::Synchronous)
   {
     PCMS_FUNCTION_TIMER;
     PCMS_ALWAYS_ASSERT(channel_.InSendCommunicationPhase());
-    auto n = field_adapter_.Serialize({}, {});
-    REDEV_ALWAYS_ASSERT(comm_buffer_.size() == static_cast<size_t>(n));
-    auto buffer = make_array_view(comm_buffer_);
-    field_adapter_.Serialize(buffer,
-                             make_const_array_view(message_permutation_));
-    comm_.Send(buffer.data_handle(), mode);
+    SerializeToBuffer();
+    comm_.Send(comm_buffer_.data(), mode);
   }
+  // Receive requires Mode::Synchronous because the data is deserialized
+  // immediately. Use PostReceive to defer deserialization.
   void Receive(Mode mode = Mode::Synchronous)
+  {
+    PCMS_FUNCTION_TIMER;
+    PostReceive(mode).Complete();
+  }
+  /**
+   * Post the receive without deserializing the data. With Mode::Deferred the
+   * data is only available once the receive communication phase ends, so
+   * PendingReceive::Complete must be called after EndReceivePhase. Only one
+   * receive can be outstanding on a field.
+   */
+  [[nodiscard]] PendingReceive PostReceive(Mode mode = Mode::Synchronous)
   {
     PCMS_FUNCTION_TIMER;
     PCMS_ALWAYS_ASSERT(channel_.InReceiveCommunicationPhase());
-    // Current implementation requires that Receive is always called in Sync
-    // mode because we make an immediate call to deserialize after a call to
-    // receive.
-    auto data = comm_.Recv(mode);
-    field_adapter_.Deserialize(make_const_array_view(data),
-                               make_const_array_view(message_permutation_));
+    // the pending receive owns received_ until it is completed
+    PCMS_ALWAYS_ASSERT(!receive_outstanding_);
+    // adios writes deferred data into the storage of the returned vector, so
+    // it must be moved (not copied) into the member
+    received_ = comm_.Recv(mode);
+    receive_outstanding_ = true;
+    return PendingReceive{[this]() {
+      receive_outstanding_ = false;
+      Unpack(make_const_array_view(received_));
+    }};
+  }
+  [[nodiscard]] std::shared_ptr<const detail::FieldLayout> GetLayout()
+    const noexcept final
+  {
+    return layout_;
+  }
+  [[nodiscard]] MPI_Comm GetMPIComm() const noexcept final
+  {
+    return mpi_comm_;
+  }
+  [[nodiscard]] ScalarArrayView<const T, HostMemorySpace> Pack() final
+  {
+    PCMS_FUNCTION_TIMER;
+    SerializeToBuffer();
+    return make_const_array_view(comm_buffer_);
+  }
+  void Unpack(ScalarArrayView<const T, HostMemorySpace> data) final
+  {
+    PCMS_FUNCTION_TIMER;
+    field_adapter_.Deserialize(
+      data, make_const_array_view(layout_->message_permutation));
   }
   /** update the permutation array and buffer sizes upon mesh change
    * @WARNING this function mut be called on *both* the client and server
    * after any modifications on the client
    */
 private:
+  void SerializeToBuffer()
+  {
+    PCMS_FUNCTION_TIMER;
+    auto n = field_adapter_.Serialize({}, {});
+    REDEV_ALWAYS_ASSERT(comm_buffer_.size() == static_cast<size_t>(n));
+    auto buffer = make_array_view(comm_buffer_);
+    field_adapter_.Serialize(
+      buffer, make_const_array_view(layout_->message_permutation));
+  }
   // note channel_ operations are collective on full channel comm
   // comm_ operations should only be called on ranks with
   void UpdateLayout()
@@ -209,18 +589,26 @@ private:
     PCMS_FUNCTION_TIMER;
     //if (mpi_comm_ != MPI_COMM_NULL) {
       auto gids = field_adapter_.GetGids();
+      auto layout = std::make_shared<detail::FieldLayout>();
+      layout->num_gids = gids.size();
+      layout->gid_hash = detail::HashGids(gids);
+      layout->participates = true;
       if (redev_.GetProcessType() == redev::ProcessType::Client) {
-        const ReversePartitionMap reverse_partition =
-          field_adapter_.GetReversePartitionMap(redev_.GetPartition());
-        auto out_message = detail::ConstructOutMessage(reverse_partition);
-        comm_.SetOutMessageLayout(out_message.dest, out_message.offset);
-        gid_comm_.SetOutMessageLayout(out_message.dest, out_message.offset);
-        message_permutation_ = detail::ConstructPermutation(reverse_partition);
+        const ReversePartition reverse_partition =
+          detail::GetReversePartition(field_adapter_, redev_.GetPartition());
+        layout->out_message = detail::ConstructOutMessage(reverse_partition);
+        comm_.SetOutMessageLayout(layout->out_message.dest,
+                                  layout->out_message.offset);
+        gid_comm_.SetOutMessageLayout(layout->out_message.dest,
+                                      layout->out_message.offset);
+        layout->message_permutation =
+          detail::ConstructPermutation(reverse_partition);
+        const auto& message_permutation = layout->message_permutation;
         // use permutation array to send the gids
         std::vector<pcms::GO> gid_msgs(gids.size());
-        REDEV_ALWAYS_ASSERT(gids.size() == message_permutation_.size());
+        REDEV_ALWAYS_ASSERT(gids.size() == message_permutation.size());
         for (size_t i = 0; i < gids.size(); ++i) {
-          gid_msgs[message_permutation_[i]] = gids[i];
+          gid_msgs[message_permutation[i]] = gids[i];
         }
         channel_.BeginSendCommunicationPhase();
         gid_comm_.Send(gid_msgs.data());
@@ -234,17 +622,18 @@ private:
         MPI_Comm_size(mpi_comm_, &nproc);
         // we require that the layout for the gids and the message are the same
         const auto in_message_layout = gid_comm_.GetInMessageLayout();
-        auto out_message =
+        layout->out_message =
           detail::ConstructOutMessage(rank, nproc, in_message_layout);
-        comm_.SetOutMessageLayout(out_message.dest, out_message.offset);
-        // construct server permutation array
-        // Verify that there are no duplicate entries in the received
-        // data. Duplicate data indicates that sender is not sending data from
-        // only the owned rank
-        REDEV_ALWAYS_ASSERT(!detail::HasDuplicates(recv_gids));
-        message_permutation_ = detail::ConstructPermutation(gids, recv_gids);
+        comm_.SetOutMessageLayout(layout->out_message.dest,
+                                  layout->out_message.offset);
+        // construct server permutation array. This also verifies that there
+        // are no duplicate entries in the received data
+        layout->message_permutation =
+          detail::ConstructPermutation(gids, recv_gids);
       }
-      comm_buffer_.resize(message_permutation_.size());
+      comm_buffer_.resize(layout->message_permutation.size());
+      layout_ = std::move(layout);
+      CacheLayout();
     //}
   }
   void UpdateLayoutNull()
@@ -258,13 +647,59 @@ private:
       channel_.BeginReceiveCommunicationPhase();
       channel_.EndReceiveCommunicationPhase();
     }
+    // ranks that do not participate in the communication store an empty
+    // layout. It is only reused by fields that this rank doesn't communicate
+    // either (see FieldLayoutCache::Find)
+    layout_ = std::make_shared<const detail::FieldLayout>();
+    CacheLayout();
+  }
+  [[nodiscard]] std::shared_ptr<const detail::FieldLayout> FindCachedLayout()
+    const
+  {
+    PCMS_FUNCTION_TIMER;
+    if (layout_cache_ == nullptr || layout_name_.empty()) {
+      return nullptr;
+    }
+    return layout_cache_->Find(layout_name_, mpi_comm_ != MPI_COMM_NULL);
+  }
+  void CacheLayout()
+  {
+    PCMS_FUNCTION_TIMER;
+    if (layout_cache_ != nullptr && !layout_name_.empty()) {
+      layout_cache_->Insert(layout_name_, layout_);
+    }
+  }
+  // reuse a layout that was constructed by another field on the same vertex
+  // set. No GID exchange happens in this case.
+  void UseLayout(std::shared_ptr<const detail::FieldLayout> layout)
+  {
+    PCMS_FUNCTION_TIMER;
+    layout_ = std::move(layout);
+    if (mpi_comm_ == MPI_COMM_NULL) {
+      return;
+    }
+    if (!detail::LayoutMatchesGids(*layout_, field_adapter_.GetGids())) {
+      std::cerr << "Field " << name_ << " does not have the same vertices as "
+                << "the cached layout " << layout_name_ << "\n";
+      std::abort();
+    }
+    // the layouts are read only on the redev side, but the redev api takes
+    // non-const references
+    auto dest = layout_->out_message.dest;
+    auto offset = layout_->out_message.offset;
+    comm_.SetOutMessageLayout(dest, offset);
+    comm_buffer_.resize(layout_->message_permutation.size());
   }
 
 private:
   MPI_Comm mpi_comm_;
   redev::Channel& channel_;
   std::vector<T> comm_buffer_;
-  std::vector<pcms::LO> message_permutation_;
+  // storage for a posted receive until it is completed
+  std::vector<T> received_;
+  bool receive_outstanding_ = false;
+  // layout is shared between all fields on the same vertex set
+  std::shared_ptr<const detail::FieldLayout> layout_;
   redev::BidirectionalComm<T> comm_;
   redev::BidirectionalComm<GO> gid_comm_;
   bool buffer_size_needs_update_;
@@ -273,13 +708,158 @@ private:
   FieldAdapterT& field_adapter_;
   redev::Redev& redev_;
   std::string name_;
+  FieldLayoutCache* layout_cache_;
+  std::string layout_name_;
 };
 template <>
 struct FieldCommunicator<void>
 {
   void Send(Mode = {}) {}
   void Receive(Mode = {}) {}
+  [[nodiscard]] PendingReceive PostReceive(Mode = {}) { return {}; }
 };
+
+/**
+ * Communicates a group of fields with the same value type as a single
+ * message. The serialized data of the fields is interleaved, so each message
+ * entry holds one value of every field. All fields in the group must have the
+ * same message layout (e.g. by adding them with the same layout name).
+ * @WARNING the group must be created with the same fields in the same order on
+ * the client and server
+ */
+class FieldGroupCommunicator
+{
+public:
+  /// a group that this rank does not communicate on
+  FieldGroupCommunicator() = default;
+  template <typename T>
+  FieldGroupCommunicator(std::string name, redev::Channel& channel,
+                         std::vector<detail::PackableField<T>*> fields)
+  {
+    PCMS_FUNCTION_TIMER;
+    group_ = std::make_unique<FieldGroupModel<T>>(std::move(name), channel,
+                                                  std::move(fields));
+  }
+  /**
+   * group fields with the value type T
+   * @param fields type erased fields (see detail::CastPackableFields)
+   */
+  template <typename T>
+  static FieldGroupCommunicator Create(
+    std::string name, redev::Channel& channel,
+    const std::vector<detail::PackableFieldBase*>& fields)
+  {
+    PCMS_FUNCTION_TIMER;
+    auto packable_fields = detail::CastPackableFields<T>(name, fields);
+    return {std::move(name), channel, std::move(packable_fields)};
+  }
+  void Send(Mode mode = Mode::Synchronous)
+  {
+    PCMS_FUNCTION_TIMER;
+    if (group_) {
+      group_->Send(mode);
+    }
+  }
+  void Receive(Mode mode = Mode::Synchronous)
+  {
+    PCMS_FUNCTION_TIMER;
+    PostReceive(mode).Complete();
+  }
+  [[nodiscard]] PendingReceive PostReceive(Mode mode = Mode::Synchronous)
+  {
+    PCMS_FUNCTION_TIMER;
+    if (group_) {
+      return group_->PostReceive(mode);
+    }
+    return {};
+  }
+
+private:
+  struct FieldGroupConcept
+  {
+    virtual void Send(Mode) = 0;
+    virtual PendingReceive PostReceive(Mode) = 0;
+    virtual ~FieldGroupConcept() = default;
+  };
+  template <typename T>
+  struct FieldGroupModel final : FieldGroupConcept
+  {
+    FieldGroupModel(std::string name, redev::Channel& channel,
+                    std::vector<detail::PackableField<T>*> fields)
+      : channel_(channel), fields_(std::move(fields))
+    {
+      PCMS_FUNCTION_TIMER;
+      PCMS_ALWAYS_ASSERT(!fields_.empty());
+      const auto layout = fields_.front()->GetLayout();
+      const auto mpi_comm = fields_.front()->GetMPIComm();
+      PCMS_ALWAYS_ASSERT(layout != nullptr);
+      for (const auto* field : fields_) {
+        const auto field_layout = field->GetLayout();
+        PCMS_ALWAYS_ASSERT(field_layout != nullptr);
+        PCMS_ALWAYS_ASSERT(
+          detail::HaveSameMessageLayout(*field_layout, *layout));
+        PCMS_ALWAYS_ASSERT(field->GetMPIComm() == mpi_comm);
+      }
+      comm_ = channel.CreateComm<T>(std::move(name), mpi_comm);
+      if (mpi_comm != MPI_COMM_NULL) {
+        auto out_message = detail::ScaleOutMessage(
+          layout->out_message, static_cast<LO>(fields_.size()));
+        comm_.SetOutMessageLayout(out_message.dest, out_message.offset);
+        buffer_.resize(layout->message_permutation.size() * fields_.size());
+      }
+    }
+    void Send(Mode mode) final
+    {
+      PCMS_FUNCTION_TIMER;
+      PCMS_ALWAYS_ASSERT(channel_.InSendCommunicationPhase());
+      detail::PackFields(fields_, buffer_);
+      comm_.Send(buffer_.data(), mode);
+    }
+    PendingReceive PostReceive(Mode mode) final
+    {
+      PCMS_FUNCTION_TIMER;
+      PCMS_ALWAYS_ASSERT(channel_.InReceiveCommunicationPhase());
+      PCMS_ALWAYS_ASSERT(!receive_outstanding_);
+      received_ = comm_.Recv(mode);
+      receive_outstanding_ = true;
+      return PendingReceive{[this]() {
+        receive_outstanding_ = false;
+        Unpack();
+      }};
+    }
+    void Unpack()
+    {
+      PCMS_FUNCTION_TIMER;
+      detail::UnpackFields(received_, fields_, unpack_buffer_);
+    }
+
+    redev::Channel& channel_;
+    std::vector<detail::PackableField<T>*> fields_;
+    redev::BidirectionalComm<T> comm_;
+    // interleaved send buffer. Must stay alive for deferred sends
+    std::vector<T> buffer_;
+    // storage for a posted receive until it is completed
+    std::vector<T> received_;
+    bool receive_outstanding_ = false;
+    std::vector<T> unpack_buffer_;
+  };
+
+  std::unique_ptr<FieldGroupConcept> group_;
+};
+
+namespace detail
+{
+// name of the message used by a group of fields
+inline std::string FieldGroupName(const std::vector<std::string>& names)
+{
+  PCMS_FUNCTION_TIMER;
+  std::string group_name;
+  for (const auto& name : names) {
+    group_name += group_name.empty() ? name : "+" + name;
+  }
+  return group_name;
+}
+} // namespace detail
 } // namespace pcms
 
 #endif // PCMS_COUPLING_FIELD_COMMUNICATOR_H
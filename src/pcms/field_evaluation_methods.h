@@ -21,15 +21,61 @@ struct NearestNeighbor
 
 struct Copy{};
 
+struct Conservative{};
+
+/// mesh free moving least squares fit to the nearest source points (see
+/// build_mls_operator)
+struct MovingLeastSquares
+{
+  static constexpr int max_neighbors = 32;
+  int num_neighbors = 12;
+};
+
+namespace detail
+{
+// distinguishes methods of the same type with different parameters, e.g. when
+// cached interpolation operators are looked up
+template <typename Method>
+constexpr int method_parameter(const Method& /* method */) noexcept
+{
+  return 0;
+}
+inline int method_parameter(const Lagrange<0>& method) noexcept
+{
+  return method.order;
+}
+inline int method_parameter(const MovingLeastSquares& method) noexcept
+{
+  return method.num_neighbors;
+}
+} // namespace detail
+
 enum class FieldTransferMethod {
   None,
   Interpolate,
-  Copy
+  Copy,
+  /// preserves the integral of the field (see build_conservative_operator)
+  Conservative
 };
 enum class FieldEvaluationMethod {
   None,
   Lagrange1,
-  NearestNeighbor
+  NearestNeighbor,
+  /// quadratic Lagrange interpolation using the vertex and edge midpoint data
+  Lagrange2,
+  /// moving least squares fit to the nearest source points. Only needs the
+  /// source point cloud, so it also works for fields without a mesh
+  MovingLeastSquares
+};
+/// how a field is evaluated at points that lie outside of its mesh. The
+/// point search reports the closest element for such points.
+enum class ExtrapolationPolicy {
+  /// evaluate the field at the closest point on the closest element
+  Clamp,
+  /// points outside of the mesh get the value zero
+  Zero,
+  /// take the value at the closest vertex of the closest element
+  NearestVertex
 };
 
 } // namespace pcms
@@ -0,0 +1,103 @@
+#ifndef PCMS_COUPLING_INTERPOLATION_OPERATOR_H
+#define PCMS_COUPLING_INTERPOLATION_OPERATOR_H
+#include "pcms/arrays.h"
+#include "pcms/assert.h"
+#include "pcms/profile.h"
+#include "pcms/types.h"
+#include <Kokkos_Core.hpp>
+#include <cmath>
+#include <type_traits>
+
+namespace pcms
+{
+
+/**
+ * Sparse linear operator that maps the values of a source field onto the
+ * points of a target field. Row i holds the source indices (columns) and
+ * weights that are combined to compute the value at target point i. The
+ * operator is stored in CSR format so it can be applied as a sparse
+ * matrix-vector product.
+ *
+ * Since the point location and weights only depend on the geometry, the
+ * operator can be built once and applied on every transfer as long as the
+ * source and target meshes do not change.
+ */
+template <typename MemorySpace>
+class InterpolationOperator
+{
+public:
+  using memory_space = MemorySpace;
+  using execution_space = typename MemorySpace::execution_space;
+
+  InterpolationOperator() = default;
+  InterpolationOperator(Kokkos::View<LO*, MemorySpace> row_offsets,
+                        Kokkos::View<LO*, MemorySpace> columns,
+                        Kokkos::View<Real*, MemorySpace> weights)
+    : row_offsets_(std::move(row_offsets)),
+      columns_(std::move(columns)),
+      weights_(std::move(weights))
+  {
+    PCMS_FUNCTION_TIMER;
+    PCMS_ALWAYS_ASSERT(row_offsets_.size() > 0);
+    PCMS_ALWAYS_ASSERT(columns_.size() == weights_.size());
+  }
+  [[nodiscard]] LO NumRows() const noexcept
+  {
+    return row_offsets_.size() > 0 ? static_cast<LO>(row_offsets_.size()) - 1
+                                   : 0;
+  }
+  [[nodiscard]] LO NumNonZeros() const noexcept
+  {
+    return static_cast<LO>(columns_.size());
+  }
+  [[nodiscard]] const Kokkos::View<LO*, MemorySpace>& GetRowOffsets()
+    const noexcept
+  {
+    return row_offsets_;
+  }
+  [[nodiscard]] const Kokkos::View<LO*, MemorySpace>& GetColumns()
+    const noexcept
+  {
+    return columns_;
+  }
+  [[nodiscard]] const Kokkos::View<Real*, MemorySpace>& GetWeights()
+    const noexcept
+  {
+    return weights_;
+  }
+  /**
+   * compute target = A * source. Integral values are rounded to the nearest
+   * integer to match the pointwise evaluation functions.
+   */
+  template <typename T, typename U>
+  void Apply(ScalarArrayView<const T, MemorySpace> source,
+             ScalarArrayView<U, MemorySpace> target) const
+  {
+    PCMS_FUNCTION_TIMER;
+    PCMS_ALWAYS_ASSERT(static_cast<LO>(target.size()) == NumRows());
+    auto row_offsets = row_offsets_;
+    auto columns = columns_;
+    auto weights = weights_;
+    Kokkos::parallel_for(
+      Kokkos::RangePolicy<execution_space>(0, NumRows()),
+      KOKKOS_LAMBDA(LO i) {
+        Real val = 0;
+        for (LO j = row_offsets(i); j < row_offsets(i + 1); ++j) {
+          val += weights(j) * source(columns(j));
+        }
+        if constexpr (std::is_integral_v<U>) {
+          val = std::round(val);
+        }
+        target(i) = val;
+      });
+  }
+
+private:
+  Kokkos::View<LO*, MemorySpace> row_offsets_;
+  Kokkos::View<LO*, MemorySpace> columns_;
+  Kokkos::View<Real*, MemorySpace> weights_;
+};
+
+} // namespace pcms
+
+#endif // PCMS_COUPLING_INTERPOLATION_OPERATOR_H
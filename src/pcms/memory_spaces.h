@@ -8,6 +8,25 @@ namespace pcms {
 //using CudaMemorySpace = Kokkos::Cuda;
 using  HostMemorySpace = Kokkos::HostSpace;
 using DefaultExecutionSpace = Kokkos::DefaultExecutionSpace;
+/// page locked host memory. Device kernels can write to it directly and
+/// transfers to and from it are faster than for pageable memory.
+#if defined(KOKKOS_ENABLE_CUDA)
+using HostPinnedMemorySpace = Kokkos::CudaHostPinnedSpace;
+#elif defined(KOKKOS_ENABLE_HIP)
+using HostPinnedMemorySpace = Kokkos::Experimental::HIPHostPinnedSpace;
+#else
+using HostPinnedMemorySpace = Kokkos::HostSpace;
+#endif
+
+/// true if MPI can send and receive directly from memory in the space. Device
+/// memory requires a GPU aware MPI (PCMS_ENABLE_GPU_AWARE_MPI).
+template <typename MemorySpace>
+inline constexpr bool mpi_accessible_v =
+#ifdef PCMS_HAS_GPU_AWARE_MPI
+  true;
+#else
+  Kokkos::SpaceAccessibility<Kokkos::HostSpace, MemorySpace>::accessible;
+#endif
 
 }
 
@@ -0,0 +1,326 @@
+#ifndef PCMS_COUPLING_MLS_INTERPOLATION_H
+#define PCMS_COUPLING_MLS_INTERPOLATION_H
+#include "pcms/arrays.h"
+#include "pcms/assert.h"
+#include "pcms/field_evaluation_methods.h"
+#include "pcms/interpolation_operator.h"
+#include "pcms/profile.h"
+#include "pcms/types.h"
+#include <Kokkos_Core.hpp>
+#include <cmath>
+#include <iterator>
+#include <type_traits>
+
+namespace pcms
+{
+namespace detail
+{
+/**
+ * Uniform grid of bins over a point cloud. The points of bin b are
+ * points(offsets(b)) ... points(offsets(b+1)-1).
+ */
+template <typename MemorySpace>
+struct PointBins
+{
+  Kokkos::View<LO*, MemorySpace> offsets;
+  Kokkos::View<LO*, MemorySpace> points;
+  Real origin[2];
+  Real cell_size[2];
+  LO divisions[2];
+
+  KOKKOS_INLINE_FUNCTION LO ClampedIndex(Real x, int d) const
+  {
+    const Real i = (x - origin[d]) / cell_size[d];
+    if (!(i > 0)) {
+      return 0;
+    }
+    return (i >= divisions[d]) ? divisions[d] - 1 : static_cast<LO>(i);
+  }
+};
+
+/// bin the points so that each bin holds about points_per_bin points
+template <typename MemorySpace>
+PointBins<MemorySpace> bin_points(
+  ScalarArrayView<const Real, MemorySpace> coordinates, Real points_per_bin)
+{
+  PCMS_FUNCTION_TIMER;
+  using execution_space = typename MemorySpace::execution_space;
+  const LO npoints = coordinates.size() / 2;
+  PCMS_ALWAYS_ASSERT(npoints > 0);
+  Real bounds[4];
+  using MinMax = Kokkos::MinMax<Real, Kokkos::HostSpace>;
+  using MinMaxValue = typename MinMax::value_type;
+  for (int d = 0; d < 2; ++d) {
+    MinMaxValue range;
+    Kokkos::parallel_reduce(
+      Kokkos::RangePolicy<execution_space>(0, npoints),
+      KOKKOS_LAMBDA(LO i, MinMaxValue & update) {
+        const Real x = coordinates(2 * i + d);
+        update.min_val = (x < update.min_val) ? x : update.min_val;
+        update.max_val = (x > update.max_val) ? x : update.max_val;
+      },
+      MinMax{range});
+    bounds[2 * d] = range.min_val;
+    bounds[2 * d + 1] = range.max_val;
+  }
+  PointBins<MemorySpace> bins;
+  const Real width = bounds[1] - bounds[0];
+  const Real height = bounds[3] - bounds[2];
+  const Real num_bins = std::fmax(1, std::ceil(npoints / points_per_bin));
+  // square bins unless the cloud is degenerate in one direction
+  if (width > 0 && height > 0) {
+    bins.divisions[0] = static_cast<LO>(
+      std::fmax(1, std::round(std::sqrt(num_bins * width / height))));
+    bins.divisions[1] = static_cast<LO>(
+      std::fmax(1, std::round(num_bins / bins.divisions[0])));
+  } else {
+    bins.divisions[0] = (width > 0) ? static_cast<LO>(num_bins) : 1;
+    bins.divisions[1] = (height > 0) ? static_cast<LO>(num_bins) : 1;
+  }
+  for (int d = 0; d < 2; ++d) {
+    const Real extent = bounds[2 * d + 1] - bounds[2 * d];
+    bins.origin[d] = bounds[2 * d];
+    bins.cell_size[d] = (extent > 0) ? extent / bins.divisions[d] : 1;
+  }
+  const LO nbins = bins.divisions[0] * bins.divisions[1];
+  Kokkos::View<LO*, MemorySpace> counts("point bin counts", nbins);
+  Kokkos::View<LO*, MemorySpace> bin_ids("point bin ids", npoints);
+  Kokkos::parallel_for(
+    Kokkos::RangePolicy<execution_space>(0, npoints), KOKKOS_LAMBDA(LO i) {
+      const LO bin = bins.ClampedIndex(coordinates(2 * i + 1), 1) *
+                       bins.divisions[0] +
+                     bins.ClampedIndex(coordinates(2 * i), 0);
+      bin_ids(i) = bin;
+      Kokkos::atomic_increment(&counts(bin));
+    });
+  bins.offsets = Kokkos::View<LO*, MemorySpace>("point bin offsets", nbins + 1);
+  auto offsets = bins.offsets;
+  Kokkos::parallel_scan(
+    Kokkos::RangePolicy<execution_space>(0, nbins + 1),
+    KOKKOS_LAMBDA(LO i, LO & update, bool final) {
+      const LO count = (i < nbins) ? counts(i) : 0;
+      if (final) {
+        offsets(i) = update;
+      }
+      update += count;
+    });
+  Kokkos::deep_copy(counts, 0);
+  bins.points = Kokkos::View<LO*, MemorySpace>("point bin points", npoints);
+  auto points = bins.points;
+  Kokkos::parallel_for(
+    Kokkos::RangePolicy<execution_space>(0, npoints), KOKKOS_LAMBDA(LO i) {
+      const LO bin = bin_ids(i);
+      points(offsets(bin) + Kokkos::atomic_fetch_add(&counts(bin), 1)) = i;
+    });
+  return bins;
+}
+
+// insert the point into the list of the k closest points, which is sorted by
+// distance. Ties are ordered by index so the result does not depend on the
+// order in which the bins were filled.
+KOKKOS_INLINE_FUNCTION
+void insert_neighbor(LO point, Real distance, LO* neighbors,
+                     Real* distances, int& count, int k)
+{
+  auto closer = [&](int j) {
+    return distance < distances[j] ||
+           (distance == distances[j] && point < neighbors[j]);
+  };
+  if (count == k && !closer(k - 1)) {
+    return;
+  }
+  int j = (count < k) ? count++ : k - 1;
+  for (; j > 0 && closer(j - 1); --j) {
+    neighbors[j] = neighbors[j - 1];
+    distances[j] = distances[j - 1];
+  }
+  neighbors[j] = point;
+  distances[j] = distance;
+}
+} // namespace detail
+
+/**
+ * Builds the operator that evaluates a moving least squares fit at the target
+ * coordinates. For each target point, a linear polynomial is fit to the
+ * num_neighbors closest source points with Gaussian weights. The kernel width
+ * is set by the distance to the farthest of those points. The fit reproduces
+ * linear fields exactly. If the neighbors are collinear, the row falls back to
+ * the normalized Gaussian weights (Shepard interpolation).
+ *
+ * Coordinates are interleaved (x0, y0, x1, y1, ...). The columns index the
+ * source points.
+ */
+template <typename MemorySpace>
+InterpolationOperator<MemorySpace> build_mls_operator(
+  ScalarArrayView<const Real, MemorySpace> source_coordinates,
+  ScalarArrayView<const Real, MemorySpace> target_coordinates,
+  MovingLeastSquares method)
+{
+  PCMS_FUNCTION_TIMER;
+  using execution_space = typename MemorySpace::execution_space;
+  constexpr int max_neighbors = MovingLeastSquares::max_neighbors;
+  PCMS_ALWAYS_ASSERT(method.num_neighbors > 0 &&
+                     method.num_neighbors <= max_neighbors);
+  const LO nsource = source_coordinates.size() / 2;
+  const LO ntarget = target_coordinates.size() / 2;
+  const int k = (method.num_neighbors < nsource) ? method.num_neighbors
+                                                 : static_cast<int>(nsource);
+  const auto bins = detail::bin_points(source_coordinates, k / 2.0 + 1);
+  Kokkos::View<LO*, MemorySpace> row_offsets("row_offsets", ntarget + 1);
+  Kokkos::View<LO*, MemorySpace> columns("columns", k * ntarget);
+  Kokkos::View<Real*, MemorySpace> weights("weights", k * ntarget);
+  Kokkos::parallel_for(
+    Kokkos::RangePolicy<execution_space>(0, ntarget + 1),
+    KOKKOS_LAMBDA(LO i) { row_offsets(i) = k * i; });
+  const LO max_ring = (bins.divisions[0] > bins.divisions[1])
+                        ? bins.divisions[0]
+                        : bins.divisions[1];
+  const Real min_cell_size = (bins.cell_size[0] < bins.cell_size[1])
+                               ? bins.cell_size[0]
+                               : bins.cell_size[1];
+  Kokkos::parallel_for(
+    Kokkos::RangePolicy<execution_space>(0, ntarget), KOKKOS_LAMBDA(LO t) {
+      const Real x = target_coordinates(2 * t);
+      const Real y = target_coordinates(2 * t + 1);
+      const LO center_col = bins.ClampedIndex(x, 0);
+      const LO center_row = bins.ClampedIndex(y, 1);
+      LO neighbors[max_neighbors];
+      Real distances[max_neighbors];
+      int count = 0;
+      // search rings of bins until the unvisited bins are farther than the
+      // k-th neighbor
+      for (LO ring = 0; ring <= max_ring; ++ring) {
+        if (count == k && distances[k - 1] <= (ring - 1) * min_cell_size *
+                                                (ring - 1) * min_cell_size) {
+          break;
+        }
+        for (LO i = center_row - ring; i <= center_row + ring; ++i) {
+          if (i < 0 || i >= bins.divisions[1]) {
+            continue;
+          }
+          for (LO j = center_col - ring; j <= center_col + ring; ++j) {
+            const bool on_ring = (i == center_row - ring) ||
+                                 (i == center_row + ring) ||
+                                 (j == center_col - ring) ||
+                                 (j == center_col + ring);
+            if (j < 0 || j >= bins.divisions[0] || !on_ring) {
+              continue;
+            }
+            const LO bin = i * bins.divisions[0] + j;
+            for (LO p = bins.offsets(bin); p < bins.offsets(bin + 1); ++p) {
+              const LO s = bins.points(p);
+              const Real dx = source_coordinates(2 * s) - x;
+              const Real dy = source_coordinates(2 * s + 1) - y;
+              detail::insert_neighbor(s, dx * dx + dy * dy, neighbors,
+                                      distances, count, k);
+            }
+          }
+        }
+      }
+      // kernel width such that the farthest neighbor still has a weight of
+      // exp(-1/2)
+      const Real h2 = 2 * distances[k - 1];
+      Real w[max_neighbors];
+      Real p[max_neighbors][3];
+      // moment matrix of the basis (1, dx/h, dy/h)
+      Real a[3][3] = {};
+      Real sum_w = 0;
+      const Real h = std::sqrt(h2);
+      for (int n = 0; n < k; ++n) {
+        const LO s = neighbors[n];
+        w[n] = (h2 > 0) ? std::exp(-distances[n] / h2) : 1;
+        p[n][0] = 1;
+        p[n][1] = (h > 0) ? (source_coordinates(2 * s) - x) / h : 0;
+        p[n][2] = (h > 0) ? (source_coordinates(2 * s + 1) - y) / h : 0;
+        for (int r = 0; r < 3; ++r) {
+          for (int c = 0; c < 3; ++c) {
+            a[r][c] += w[n] * p[n][r] * p[n][c];
+          }
+        }
+        sum_w += w[n];
+      }
+      // first column of the inverse of the (symmetric) moment matrix
+      const Real c00 = a[1][1] * a[2][2] - a[1][2] * a[2][1];
+      const Real c01 = a[1][2] * a[2][0] - a[1][0] * a[2][2];
+      const Real c02 = a[1][0] * a[2][1] - a[1][1] * a[2][0];
+      const Real det = a[0][0] * c00 + a[0][1] * c01 + a[0][2] * c02;
+      const bool singular =
+        !(std::abs(det) > 1E-10 * sum_w * sum_w * sum_w);
+      for (int n = 0; n < k; ++n) {
+        columns(k * t + n) = neighbors[n];
+        weights(k * t + n) =
+          singular
+            ? w[n] / sum_w
+            : w[n] * (c00 * p[n][0] + c01 * p[n][1] + c02 * p[n][2]) / det;
+      }
+    });
+  return {row_offsets, columns, weights};
+}
+
+/**
+ * Builds the moving least squares operator (see build_mls_operator) from the
+ * nodal coordinates of any field that provides get_nodal_coordinates to the
+ * target coordinates.
+ */
+template <typename Field, typename MemorySpace>
+InterpolationOperator<MemorySpace> build_field_mls_operator(
+  const Field& field, MovingLeastSquares method,
+  ScalarArrayView<const Real, MemorySpace> coordinates)
+{
+  PCMS_FUNCTION_TIMER;
+  using UnmanagedTraits = Kokkos::MemoryTraits<Kokkos::Unmanaged>;
+  const auto source_coordinates = get_nodal_coordinates(field);
+  using source_memory_space = detail::memory_space_selector_t<
+    std::remove_cv_t<decltype(source_coordinates)>>;
+  auto source_coordinates_d = Kokkos::create_mirror_view_and_copy(
+    MemorySpace{},
+    Kokkos::View<const Real*, source_memory_space, UnmanagedTraits>(
+      std::data(source_coordinates), std::size(source_coordinates)));
+  return build_mls_operator(make_const_array_view(source_coordinates_d),
+                            coordinates, method);
+}
+
+/**
+ * Applies an operator whose columns index the nodes of the field (e.g. from
+ * build_field_mls_operator) to the current nodal data of the field.
+ */
+template <typename Field, typename MemorySpace>
+auto apply_field_operator(const Field& field,
+                          const InterpolationOperator<MemorySpace>& op)
+  -> Kokkos::View<typename Field::value_type*, MemorySpace>
+{
+  PCMS_FUNCTION_TIMER;
+  using T = typename Field::value_type;
+  using UnmanagedTraits = Kokkos::MemoryTraits<Kokkos::Unmanaged>;
+  const auto source_values = get_nodal_data(field);
+  using source_memory_space = detail::memory_space_selector_t<
+    std::remove_cv_t<decltype(source_values)>>;
+  auto source_values_d = Kokkos::create_mirror_view_and_copy(
+    MemorySpace{},
+    Kokkos::View<const T*, source_memory_space, UnmanagedTraits>(
+      std::data(source_values), std::size(source_values)));
+  Kokkos::View<T*, MemorySpace> values("mls values", op.NumRows());
+  op.Apply(make_const_array_view(source_values_d), make_array_view(values));
+  return values;
+}
+
+/**
+ * Mesh free evaluation with moving least squares (see build_mls_operator) for
+ * any field that provides get_nodal_coordinates and get_nodal_data. The
+ * operator is rebuilt on every call. Field adapters that are evaluated
+ * repeatedly at the same points cache the result of build_field_mls_operator
+ * and apply it with apply_field_operator instead (see XGCFieldAdapter).
+ */
+template <typename Field, typename MemorySpace>
+auto evaluate_mls(const Field& field, MovingLeastSquares method,
+                  ScalarArrayView<const Real, MemorySpace> coordinates)
+  -> Kokkos::View<typename Field::value_type*, MemorySpace>
+{
+  PCMS_FUNCTION_TIMER;
+  return apply_field_operator(
+    field, build_field_mls_operator(field, method, coordinates));
+}
+
+} // namespace pcms
+
+#endif // PCMS_COUPLING_MLS_INTERPOLATION_H
@@ -8,6 +8,7 @@
 #include <Kokkos_Core.hpp>
 #include <pcms/assert.h>
 #include <Omega_h_for.hpp>
+#include <Omega_h_array_ops.hpp>
 #include "pcms/arrays.h"
 #include "pcms/array_mask.h"
 #include "pcms/point_search.h"
@@ -15,7 +16,23 @@
 #include "pcms/transfer_field.h"
 #include "pcms/memory_spaces.h"
 #include "pcms/profile.h"
+#include "pcms/interpolation_operator.h"
+#include "pcms/conservative_transfer.h"
+#include "pcms/mls_interpolation.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <iterator>
+#include <limits>
 #include <optional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <typeindex>
+#include <utility>
+#include <vector>
 
 
 // FIXME add executtion spaces (don't use kokkos exe spaces directly)
@@ -71,6 +88,24 @@ Omega_h::Read<T> filter_array(Omega_h::Read<T> array,
     });
   return filtered_field;
 }
+// mesh vertex of each entry of the filtered array (inverse of the index
+// mask). The identity if there is no mask.
+inline Omega_h::Read<LO> filtered_vertex_ids(const Omega_h::Read<LO>& mask,
+                                             LO size)
+{
+  PCMS_FUNCTION_TIMER;
+  if (!mask.exists()) {
+    return Omega_h::LOs(size, 0, 1);
+  }
+  Omega_h::Write<LO> vertex_ids(size);
+  Omega_h::parallel_for(
+    mask.size(), OMEGA_H_LAMBDA(LO i) {
+      if (mask[i]) {
+        vertex_ids[mask[i] - 1] = i;
+      }
+    });
+  return vertex_ids;
+}
 struct GetRankOmegaH
 {
   GetRankOmegaH(int i, Omega_h::HostRead<Omega_h::I8> dims,
@@ -96,6 +131,144 @@ struct GetRankOmegaH
   Omega_h::HostRead<Omega_h::ClassId> ids_;
   Omega_h::HostRead<Omega_h::I8> dims_;
 };
+/**
+ * State shared by all OmegaHFields on the same mesh. It is created by the
+ * first field on a mesh and released with the last one. The id is unique for
+ * the lifetime of the process, so caches keyed by it never confuse a mesh
+ * with a later mesh allocated at the same address.
+ */
+struct OmegaHMeshState
+{
+  size_t id;
+  // number of times the caches derived from the mesh were invalidated (see
+  // OmegaHField::InvalidateCaches)
+  std::atomic<size_t> generation{0};
+  // writable arrays backing vertex tags, by tag name and value type
+  std::map<std::pair<std::string, std::type_index>, std::shared_ptr<void>>
+    tag_arrays;
+
+  /**
+   * Writable array backing the vertex tag of the mesh. Every
+   * OmegaHFieldAdapter on the tag gets the same array, so adapters on the
+   * same tag write into the same storage instead of replacing each other's
+   * array. If the tag was replaced since the last call (e.g. by
+   * set_nodal_data), its current values are copied into a new backing array.
+   */
+  template <typename T>
+  Omega_h::Write<T> GetTagArray(Omega_h::Mesh& mesh, const std::string& name)
+  {
+    PCMS_FUNCTION_TIMER;
+    auto& entry = tag_arrays[{name, std::type_index(typeid(T))}];
+    auto* array = static_cast<Omega_h::Write<T>*>(entry.get());
+    const bool has_tag = mesh.has_tag(0, name);
+    if (array != nullptr && has_tag &&
+        mesh.template get_array<T>(0, name).data() == array->data()) {
+      return *array;
+    }
+    auto backing = std::make_shared<Omega_h::Write<T>>(
+      has_tag ? Omega_h::deep_copy(mesh.template get_array<T>(0, name))
+              : Omega_h::Write<T>(mesh.nverts(), 0));
+    if (has_tag) {
+      mesh.set_tag(0, name, Omega_h::Read<T>(*backing));
+    } else {
+      mesh.add_tag(0, name, 1, Omega_h::Read<T>(*backing));
+    }
+    entry = backing;
+    return *backing;
+  }
+};
+inline std::shared_ptr<OmegaHMeshState> GetMeshState(const Omega_h::Mesh& mesh)
+{
+  PCMS_FUNCTION_TIMER;
+  using Registry =
+    std::map<const Omega_h::Mesh*, std::weak_ptr<OmegaHMeshState>>;
+  // never destroyed, so states released during static destruction can still
+  // remove their entry
+  static auto* registry = new Registry;
+  static auto* mutex = new std::mutex;
+  static size_t next_id = 0;
+  std::lock_guard<std::mutex> lock(*mutex);
+  auto& entry = (*registry)[&mesh];
+  if (auto state = entry.lock()) {
+    return state;
+  }
+  const Omega_h::Mesh* mesh_address = &mesh;
+  std::shared_ptr<OmegaHMeshState> state(
+    new OmegaHMeshState{next_id++}, [mesh_address](OmegaHMeshState* released) {
+      {
+        std::lock_guard<std::mutex> release_lock(*mutex);
+        // a new state for the mesh may already have replaced the entry
+        auto it = registry->find(mesh_address);
+        if (it != registry->end() && it->second.expired()) {
+          registry->erase(it);
+        }
+      }
+      delete released;
+    });
+  entry = state;
+  return state;
+}
+/// identity of the mask of a field. Copies of the field share it.
+struct MaskIdentity
+{
+  size_t id;
+};
+inline std::shared_ptr<const MaskIdentity> NewMaskIdentity()
+{
+  static std::atomic<size_t> next_id{1};
+  return std::make_shared<const MaskIdentity>(MaskIdentity{next_id++});
+}
+// identifies the target of a cached interpolation operator. The operator only
+// depends on the target vertices, so any field on the same mesh with the same
+// mask reuses it. The mesh and the mask are identified by ids that are never
+// reused. The key only holds weak references to them, so an operator whose
+// target mesh or mask no longer exists can be dropped. The mesh generation
+// makes operators cached on any source field miss once the target mesh was
+// modified.
+struct InterpolationOperatorKey
+{
+  template <typename Method>
+  InterpolationOperatorKey(const std::shared_ptr<OmegaHMeshState>& mesh_state,
+                           const std::shared_ptr<const MaskIdentity>& mask,
+                           LO size, const Method& method_value)
+    : target_mesh_id(mesh_state->id),
+      target_mesh_state(mesh_state),
+      target_generation(mesh_state->generation),
+      target_mask_id(mask ? mask->id : 0),
+      target_mask(mask),
+      target_size(size),
+      method(typeid(Method)),
+      method_parameter(detail::method_parameter(method_value))
+  {
+  }
+  size_t target_mesh_id;
+  std::weak_ptr<const OmegaHMeshState> target_mesh_state;
+  size_t target_generation;
+  // 0 if the target has no mask
+  size_t target_mask_id;
+  std::weak_ptr<const MaskIdentity> target_mask;
+  LO target_size;
+  std::type_index method;
+  // e.g. the number of neighbors of MovingLeastSquares
+  int method_parameter;
+  // false once the target mesh or mask was released or the target mesh was
+  // modified after the key was made
+  [[nodiscard]] bool IsCurrent() const
+  {
+    const auto mesh_state = target_mesh_state.lock();
+    return mesh_state != nullptr &&
+           (target_mask_id == 0 || !target_mask.expired()) &&
+           target_generation == mesh_state->generation;
+  }
+  bool operator<(const InterpolationOperatorKey& other) const noexcept
+  {
+    return std::tie(target_mesh_id, target_generation, target_mask_id,
+                    target_size, method, method_parameter) <
+           std::tie(other.target_mesh_id, other.target_generation,
+                    other.target_mask_id, other.target_size, other.method,
+                    other.method_parameter);
+  }
+};
 } // namespace detail
 
 template <typename T,
@@ -107,11 +280,15 @@ public:
   using memory_space = OmegaHMemorySpace::type;
   using value_type = T;
   using coordinate_element_type = CoordinateElementType;
-  OmegaHField(Omega_h::Mesh& mesh) : mesh_(&mesh), size_(mesh.nents(0)) {}
+  OmegaHField(Omega_h::Mesh& mesh)
+    : mesh_(&mesh), mesh_state_(detail::GetMeshState(mesh)), size_(mesh.nents(0))
+  {
+  }
   OmegaHField(std::string name, Omega_h::Mesh& mesh,
               std::string global_id_name = "") 
     : name_(std::move(name)),
       mesh_(&mesh),
+      mesh_state_(detail::GetMeshState(mesh)),
       size_(mesh.nents(0)),
       global_id_name_(std::move(global_id_name))
   {
@@ -121,6 +298,7 @@ public:
               Omega_h::Read<Omega_h::I8> mask, std::string global_id_name = "")
     : name_(std::move(name)),
       mesh_(&mesh),
+      mesh_state_(detail::GetMeshState(mesh)),
       global_id_name_(std::move(global_id_name))
   {
     PCMS_FUNCTION_TIMER;
@@ -139,6 +317,7 @@ public:
         policy, detail::ComputeMaskAV{index_mask_view, mask_view}, size_);
       Kokkos::parallel_for(policy, detail::ScaleAV{index_mask_view, mask_view});
       mask_ = index_mask;
+      mask_identity_ = detail::NewMaskIdentity();
     } else {
       size_ = mesh.nents(0);
     }
@@ -153,36 +332,181 @@ public:
     return mask_;
   };
   [[nodiscard]] bool HasMask() const noexcept { return mask_.exists(); };
+  /// state shared by all fields on the mesh (see detail::OmegaHMeshState)
+  [[nodiscard]] const std::shared_ptr<detail::OmegaHMeshState>& GetMeshState()
+    const noexcept
+  {
+    return mesh_state_;
+  }
+  /// null if the field has no mask
+  [[nodiscard]] const std::shared_ptr<const detail::MaskIdentity>&
+  GetMaskIdentity() const noexcept
+  {
+    return mask_identity_;
+  }
   [[nodiscard]] LO Size() const noexcept { return size_; }
   void ConstructSearch(int nx, int ny)
   {
     PCMS_FUNCTION_TIMER;
     search_ = GridPointSearch(*mesh_, nx, ny);
   }
+  /**
+   * construct the point search. The uniform grid chooses its resolution from
+   * the mesh size. The BVH is better suited to strongly graded meshes.
+   */
+  void ConstructSearch(
+    PointSearchMethod method = PointSearchMethod::UniformGrid)
+  {
+    PCMS_FUNCTION_TIMER;
+    switch (method) {
+      case PointSearchMethod::UniformGrid:
+        search_ = GridPointSearch(*mesh_);
+        return;
+      case PointSearchMethod::BVH: search_ = BVHPointSearch(*mesh_); return;
+        // no default case for compiler error on missing search method
+    }
+  }
+  /// use a search that was configured by the caller, e.g. with sorted queries
+  void SetSearch(PointSearch search)
+  {
+    PCMS_FUNCTION_TIMER;
+    search_ = std::move(search);
+  }
+  [[nodiscard]] bool HasSearch() const noexcept { return search_.has_value(); }
+  /// set how the field is evaluated at points that lie outside of the mesh
+  void SetExtrapolationPolicy(ExtrapolationPolicy policy)
+  {
+    PCMS_FUNCTION_TIMER;
+    if (policy != extrapolation_policy_) {
+      extrapolation_policy_ = policy;
+      // cached operators were built with the old policy
+      interpolation_operators_.clear();
+    }
+  }
+  [[nodiscard]] ExtrapolationPolicy GetExtrapolationPolicy() const noexcept
+  {
+    return extrapolation_policy_;
+  }
+  [[nodiscard]] const PointSearch& GetSearch() const
+  {
+    PCMS_ALWAYS_ASSERT(search_.has_value());
+    return *search_;
+  }
   // pass through to search function
   [[nodiscard]] auto Search(Kokkos::View<Real* [2]> points) const {
     PCMS_FUNCTION_TIMER;
     PCMS_ALWAYS_ASSERT(search_.has_value() && "search data structure must be constructed before use");
-    return (*search_)(points); 
+    return std::visit([&](const auto& search) { return search(points); },
+                      *search_);
+  }
+
+  /**
+   * Returns the cached interpolation operator for the key or builds and caches
+   * it with build(). The operators depend only on the mesh geometry, so they
+   * are reused for every transfer from this field to the same target.
+   */
+  template <typename Func>
+  [[nodiscard]] const InterpolationOperator<memory_space>&
+  GetInterpolationOperator(const detail::InterpolationOperatorKey& key,
+                           Func&& build) const
+  {
+    PCMS_FUNCTION_TIMER;
+    // drop the operators to targets that were released or modified since the
+    // operators were built. This bounds the cache by the live targets.
+    for (auto stale = interpolation_operators_.begin();
+         stale != interpolation_operators_.end();) {
+      stale = stale->first.IsCurrent() ? std::next(stale)
+                                       : interpolation_operators_.erase(stale);
+    }
+    auto it = interpolation_operators_.find(key);
+    if (it == interpolation_operators_.end()) {
+      it = interpolation_operators_
+             .emplace(key,
+                      std::make_shared<const InterpolationOperator<memory_space>>(
+                        std::forward<Func>(build)()))
+             .first;
+    }
+    return *(it->second);
+  }
+  [[nodiscard]] size_t NumInterpolationOperators() const noexcept
+  {
+    return interpolation_operators_.size();
   }
 
+  /**
+   * Drops everything derived from the mesh: the filtered class ids, class
+   * dims, gids and coordinates, the point search, and the interpolation
+   * operators. Call this after the mesh is modified (e.g. adapted or
+   * renumbered) on every field defined on that mesh. The search must be
+   * constructed again before it is used. Operators cached on fields of other
+   * meshes that target this mesh are rebuilt on their next use since the
+   * generation of the mesh is part of their key.
+   */
+  void InvalidateCaches()
+  {
+    PCMS_FUNCTION_TIMER;
+    ++mesh_state_->generation;
+    class_ids_ = {};
+    class_dims_ = {};
+    gids_ = {};
+    coordinates_ = {};
+    search_.reset();
+    interpolation_operators_.clear();
+  }
+
+  // The getters below filter the mesh arrays once and return the cached
+  // result afterwards. The mesh and mask are assumed not to change until
+  // InvalidateCaches is called.
   [[nodiscard]] Omega_h::Read<Omega_h::ClassId> GetClassIDs() const
   {
     PCMS_FUNCTION_TIMER;
-    if (HasMask())
-      return detail::filter_array(
-        mesh_->get_array<Omega_h::ClassId>(0, "class_id"), GetMask(), Size());
-    return mesh_->get_array<Omega_h::ClassId>(0, "class_id");
+    if (!class_ids_.exists()) {
+      class_ids_ =
+        FilterArray(mesh_->get_array<Omega_h::ClassId>(0, "class_id"));
+    }
+    return class_ids_;
   }
   [[nodiscard]] Omega_h::Read<Omega_h::I8> GetClassDims() const
   {
     PCMS_FUNCTION_TIMER;
-    if (HasMask())
-      return detail::filter_array(mesh_->get_array<Omega_h::I8>(0, "class_dim"),
-                                  GetMask(), Size());
-    return mesh_->get_array<Omega_h::I8>(0, "class_dim");
+    if (!class_dims_.exists()) {
+      class_dims_ = FilterArray(mesh_->get_array<Omega_h::I8>(0, "class_dim"));
+    }
+    return class_dims_;
   }
   [[nodiscard]] Omega_h::Read<Omega_h::GO> GetGids() const
+  {
+    PCMS_FUNCTION_TIMER;
+    if (!gids_.exists()) {
+      gids_ = FilterArray(ReadGids());
+    }
+    return gids_;
+  }
+  /// vertex coordinates (x,y interleaved) of the field
+  [[nodiscard]] Omega_h::Reals GetCoordinates() const
+  {
+    PCMS_FUNCTION_TIMER;
+    static constexpr auto coordinate_dimension = 2;
+    if (!coordinates_.exists()) {
+      const auto coords = mesh_->coords();
+      coordinates_ =
+        HasMask() ? detail::filter_array<Real, coordinate_dimension>(
+                      coords, GetMask(), Size())
+                  : coords;
+    }
+    return coordinates_;
+  }
+
+private:
+  template <typename U>
+  [[nodiscard]] Omega_h::Read<U> FilterArray(Omega_h::Read<U> array) const
+  {
+    if (HasMask()) {
+      return detail::filter_array(array, GetMask(), Size());
+    }
+    return array;
+  }
+  [[nodiscard]] Omega_h::Read<Omega_h::GO> ReadGids() const
   {
     PCMS_FUNCTION_TIMER;
     Omega_h::Read<Omega_h::GO> gid_array;
@@ -203,21 +527,47 @@ public:
         std::abort();
       }
     }
-    if (HasMask()) {
-      return detail::filter_array(gid_array, GetMask(), Size());
-    }
     return gid_array;
   }
-private:
+
   std::string name_;
   Omega_h::Mesh* mesh_;
-  std::optional<GridPointSearch> search_;
+  std::shared_ptr<detail::OmegaHMeshState> mesh_state_;
+  std::optional<PointSearch> search_;
+  ExtrapolationPolicy extrapolation_policy_ = ExtrapolationPolicy::Clamp;
+  // interpolation operators from this field to other fields
+  mutable std::map<
+    detail::InterpolationOperatorKey,
+    std::shared_ptr<const InterpolationOperator<memory_space>>>
+    interpolation_operators_;
   // bitmask array that specifies a filter on the field
   Omega_h::Read<LO> mask_;
+  std::shared_ptr<const detail::MaskIdentity> mask_identity_;
   LO size_;
   std::string global_id_name_;
+  // arrays derived from the mesh, filled on first use
+  mutable Omega_h::Read<Omega_h::ClassId> class_ids_;
+  mutable Omega_h::Read<Omega_h::I8> class_dims_;
+  mutable Omega_h::Read<Omega_h::GO> gids_;
+  mutable Omega_h::Reals coordinates_;
 };
 
+/**
+ * true if both fields are defined on the same vertices of the same mesh in the
+ * same order (same mesh and same mask)
+ */
+template <typename T, typename U, typename C>
+[[nodiscard]] bool HasSameVertices(const OmegaHField<T, C>& a,
+                                   const OmegaHField<U, C>& b)
+{
+  PCMS_FUNCTION_TIMER;
+  if (&a.GetMesh() != &b.GetMesh() || a.Size() != b.Size() ||
+      a.HasMask() != b.HasMask()) {
+    return false;
+  }
+  return !a.HasMask() || a.GetMask() == b.GetMask();
+}
+
 using InternalCoordinateElement = Real;
 // internal field can only be one of the types supported by Omega_h
 // The coordinate element for all internal fields is the same since
@@ -228,6 +578,9 @@ using InternalField =
                OmegaHField<Omega_h::I64, InternalCoordinateElement>,
                OmegaHField<Omega_h::Real, InternalCoordinateElement>>;
 
+// Without a mask this returns the tag array itself. If an OmegaHFieldAdapter
+// deserializes into the same tag, the array is updated in place (see
+// OmegaHFieldAdapter::Deserialize).
 template <typename T, typename CoordinateElementType>
 auto get_nodal_data(const OmegaHField<T, CoordinateElementType>& field)
   -> Omega_h::Read<T>
@@ -246,20 +599,13 @@ template <typename T, typename CoordinateElementType>
 auto get_nodal_coordinates(const OmegaHField<T, CoordinateElementType>& field)
 {
   PCMS_FUNCTION_TIMER;
-  static constexpr auto coordinate_dimension = 2;
   if constexpr (detail::HasCoordinateSystem<CoordinateElementType>::value) {
     const auto coords = field.GetMesh().coords();
     return MDArray<CoordinateElementType>{};
     // FIXME implement copy to
     throw;
   } else {
-    auto coords = Omega_h::Reals{field.GetMesh().coords()};
-    if (field.HasMask()) {
-      return detail::filter_array<typename decltype(coords)::value_type,
-                                  coordinate_dimension>(coords, field.GetMask(),
-                                                        field.Size());
-    }
-    return coords;
+    return field.GetCoordinates();
   }
   // should never be here. Quash warning
   return Omega_h::Reals{};
@@ -311,71 +657,120 @@ auto set_nodal_data(const OmegaHField<T, CoordinateElementType>& field,
   PCMS_ALWAYS_ASSERT(mesh.has_tag(0, field.GetName()));
 }
 
-// TODO abstract out repeat parts of lagrange/nearest neighbor evaluation
-template <typename T, typename CoordinateElementType>
-auto evaluate(
-  const OmegaHField<T, CoordinateElementType>& field, Lagrange<1> /* method */,
+namespace detail
+{
+template <typename CoordinateElementType>
+Kokkos::View<Real* [2]> copy_coordinates(
   ScalarArrayView<const CoordinateElementType, OmegaHMemorySpace::type>
-    coordinates) -> Omega_h::Read<T>
+    coordinates)
 {
   PCMS_FUNCTION_TIMER;
-  Omega_h::Write<T> values(coordinates.size() / 2);
-  auto tris2verts = field.GetMesh().ask_elem_verts();
-  auto field_values = field.GetMesh().template get_array<T>(0, field.GetName());
-
   Kokkos::View<Real* [2]> coords("coords", coordinates.size() / 2);
   Kokkos::parallel_for(
     coordinates.size() / 2, KOKKOS_LAMBDA(LO i) {
       coords(i, 0) = coordinates(2 * i);
       coords(i, 1) = coordinates(2 * i + 1);
     });
-  auto results = field.Search(coords);
+  return coords;
+}
+
+// modify the (clamped) parametric coordinates of a point outside of the mesh
+// according to the extrapolation policy
+KOKKOS_INLINE_FUNCTION
+void apply_extrapolation_policy(ExtrapolationPolicy policy,
+                                Omega_h::Vector<3>& coord)
+{
+  switch (policy) {
+    case ExtrapolationPolicy::Clamp: return;
+    case ExtrapolationPolicy::Zero:
+      coord = Omega_h::Vector<3>{0, 0, 0};
+      return;
+    case ExtrapolationPolicy::NearestVertex: {
+      int vert = 0;
+      for (int j = 1; j < 3; ++j) {
+        if (coord[j] > coord[vert]) {
+          vert = j;
+        }
+      }
+      coord = Omega_h::Vector<3>{0, 0, 0};
+      coord[vert] = 1;
+      return;
+    }
+  }
+}
 
+/**
+ * Builds the operator that evaluates the linear Lagrange interpolant of the
+ * field at the coordinates. Each row holds the three vertices of the
+ * containing triangle weighted by the barycentric coordinates. Points outside
+ * of the mesh use the closest element and the field's extrapolation policy.
+ */
+template <typename T, typename CoordinateElementType>
+auto build_interpolation_operator(
+  const OmegaHField<T, CoordinateElementType>& field, Lagrange<1> /* method */,
+  ScalarArrayView<const CoordinateElementType, OmegaHMemorySpace::type>
+    coordinates) -> InterpolationOperator<OmegaHMemorySpace::type>
+{
+  PCMS_FUNCTION_TIMER;
+  using memory_space = OmegaHMemorySpace::type;
+  auto tris2verts = field.GetMesh().ask_elem_verts();
+  auto results = field.Search(copy_coordinates(coordinates));
+  const LO npoints = results.size();
+  Kokkos::View<LO*, memory_space> row_offsets("row_offsets", npoints + 1);
+  Kokkos::View<LO*, memory_space> columns("columns", 3 * npoints);
+  Kokkos::View<Real*, memory_space> weights("weights", 3 * npoints);
+  const auto policy = field.GetExtrapolationPolicy();
   Kokkos::parallel_for(
-    results.size(), KOKKOS_LAMBDA(LO i) {
+    npoints + 1, KOKKOS_LAMBDA(LO i) { row_offsets(i) = 3 * i; });
+  Kokkos::parallel_for(
+    npoints, KOKKOS_LAMBDA(LO i) {
       auto [elem_idx, coord] = results(i);
-      // TODO deal with case for elem_idx < 0 (point outside of mesh)
-      KOKKOS_ASSERT(elem_idx >= 0);
+      const bool outside = elem_idx < 0;
+      if (outside) {
+        elem_idx = decode_outside_element(elem_idx);
+        detail::apply_extrapolation_policy(policy, coord);
+      }
       const auto elem_tri2verts =
         Omega_h::gather_verts<3>(tris2verts, elem_idx);
-      Real val = 0;
       for (int j = 0; j < 3; ++j) {
-        val += field_values[elem_tri2verts[j]] * coord[j];
+        columns(3 * i + j) = elem_tri2verts[j];
+        weights(3 * i + j) = coord[j];
       }
-      if constexpr (std::is_integral_v<T>) {
-        val = std::round(val);
-      }
-      values[i] = val;
     });
-
-  return values;
+  return {row_offsets, columns, weights};
 }
 
+/**
+ * Builds the operator that takes the value of the triangle vertex closest
+ * to each coordinate (the vertex with the largest barycentric coordinate).
+ */
 template <typename T, typename CoordinateElementType>
-auto evaluate(
+auto build_interpolation_operator(
   const OmegaHField<T, CoordinateElementType>& field,
   NearestNeighbor /* method */,
   ScalarArrayView<const CoordinateElementType, OmegaHMemorySpace::type>
-    coordinates) -> Omega_h::Read<T>
+    coordinates) -> InterpolationOperator<OmegaHMemorySpace::type>
 {
   PCMS_FUNCTION_TIMER;
-  Omega_h::Write<T> values(coordinates.size() / 2);
+  using memory_space = OmegaHMemorySpace::type;
   auto tris2verts = field.GetMesh().ask_elem_verts();
-  auto field_values = field.GetMesh().template get_array<T>(0, field.GetName());
-  // TODO reuse coordinates_data if possible
-  Kokkos::View<Real* [2]> coords("coords", coordinates.size() / 2);
+  auto results = field.Search(copy_coordinates(coordinates));
+  const LO npoints = results.size();
+  Kokkos::View<LO*, memory_space> row_offsets("row_offsets", npoints + 1);
+  Kokkos::View<LO*, memory_space> columns("columns", npoints);
+  Kokkos::View<Real*, memory_space> weights("weights", npoints);
+  const auto policy = field.GetExtrapolationPolicy();
   Kokkos::parallel_for(
-    coordinates.size() / 2, KOKKOS_LAMBDA(LO i) {
-      coords(i, 0) = coordinates(2 * i);
-      coords(i, 1) = coordinates(2 * i + 1);
-    });
-  auto results = field.Search(coords);
-
+    npoints + 1, KOKKOS_LAMBDA(LO i) { row_offsets(i) = i; });
   Kokkos::parallel_for(
-    results.size(), KOKKOS_LAMBDA(LO i) {
+    npoints, KOKKOS_LAMBDA(LO i) {
       auto [elem_idx, coord] = results(i);
-      // TODO deal with case for elem_idx < 0 (point outside of mesh)
-      KOKKOS_ASSERT(elem_idx >= 0);
+      // clamp and nearest vertex both take the closest vertex
+      Real weight = 1;
+      if (elem_idx < 0) {
+        elem_idx = decode_outside_element(elem_idx);
+        weight = (policy == ExtrapolationPolicy::Zero) ? 0 : 1;
+      }
       const auto elem_tri2verts =
         Omega_h::gather_verts<3>(tris2verts, elem_idx);
       // value is closest to point has the largest coordinate
@@ -388,11 +783,339 @@ auto evaluate(
           vert = j;
         }
       }
-      values[i] = field_values[elem_tri2verts[vert]];
+      columns(i) = elem_tri2verts[vert];
+      weights(i) = weight;
+    });
+  return {row_offsets, columns, weights};
+}
+
+/**
+ * Builds the operator that evaluates the quadratic Lagrange interpolant of the
+ * field at the coordinates. Each row holds the three vertices and the three
+ * edges of the containing triangle weighted by the P2 shape functions. Edge
+ * columns are offset by the number of vertices (see interpolation_dofs).
+ */
+template <typename T, typename CoordinateElementType>
+auto build_interpolation_operator(
+  const OmegaHField<T, CoordinateElementType>& field, Lagrange<2> /* method */,
+  ScalarArrayView<const CoordinateElementType, OmegaHMemorySpace::type>
+    coordinates) -> InterpolationOperator<OmegaHMemorySpace::type>
+{
+  PCMS_FUNCTION_TIMER;
+  using memory_space = OmegaHMemorySpace::type;
+  auto& mesh = field.GetMesh();
+  auto tris2verts = mesh.ask_elem_verts();
+  auto tris2edges = mesh.ask_down(2, 1).ab2b;
+  const LO nverts = mesh.nverts();
+  auto results = field.Search(copy_coordinates(coordinates));
+  const LO npoints = results.size();
+  Kokkos::View<LO*, memory_space> row_offsets("row_offsets", npoints + 1);
+  Kokkos::View<LO*, memory_space> columns("columns", 6 * npoints);
+  Kokkos::View<Real*, memory_space> weights("weights", 6 * npoints);
+  const auto policy = field.GetExtrapolationPolicy();
+  Kokkos::parallel_for(
+    npoints + 1, KOKKOS_LAMBDA(LO i) { row_offsets(i) = 6 * i; });
+  Kokkos::parallel_for(
+    npoints, KOKKOS_LAMBDA(LO i) {
+      auto [elem_idx, coord] = results(i);
+      if (elem_idx < 0) {
+        elem_idx = decode_outside_element(elem_idx);
+        detail::apply_extrapolation_policy(policy, coord);
+      }
+      const auto elem_tri2verts =
+        Omega_h::gather_verts<3>(tris2verts, elem_idx);
+      for (int j = 0; j < 3; ++j) {
+        columns(6 * i + j) = elem_tri2verts[j];
+        weights(6 * i + j) = coord[j] * (2 * coord[j] - 1);
+        // Omega_h triangle edge j connects vertices j and (j+1)%3
+        columns(6 * i + 3 + j) = nverts + tris2edges[3 * elem_idx + j];
+        weights(6 * i + 3 + j) = 4 * coord[j] * coord[(j + 1) % 3];
+      }
+    });
+  return {row_offsets, columns, weights};
+}
+
+/**
+ * Builds the moving least squares operator (see build_mls_operator) from the
+ * field's vertices to the coordinates. Only the vertices selected by the mask
+ * are used as source points. The columns are mapped back to the mesh vertex
+ * ids.
+ */
+template <typename T, typename CoordinateElementType>
+auto build_interpolation_operator(
+  const OmegaHField<T, CoordinateElementType>& field, MovingLeastSquares method,
+  ScalarArrayView<const CoordinateElementType, OmegaHMemorySpace::type>
+    coordinates) -> InterpolationOperator<OmegaHMemorySpace::type>
+{
+  PCMS_FUNCTION_TIMER;
+  const auto source_coordinates = get_nodal_coordinates(field);
+  auto op = build_mls_operator(make_const_array_view(source_coordinates),
+                               coordinates, method);
+  if (field.HasMask()) {
+    const auto mask_to_vert =
+      filtered_vertex_ids(field.GetMask(), field.Size());
+    auto columns = op.GetColumns();
+    Kokkos::parallel_for(
+      columns.size(),
+      KOKKOS_LAMBDA(LO i) { columns(i) = mask_to_vert[columns(i)]; });
+  }
+  return op;
+}
+
+/**
+ * Values of the field at the edge midpoints. If the mesh has a tag with the
+ * field's name on the edges, it holds the midpoint values. Otherwise they are
+ * recovered from the vertex values. The vertex gradients are the area
+ * weighted average of the gradients of the adjacent triangles. The midpoint
+ * value of the edge (a,b) is then (u_a+u_b)/2 - (g_b-g_a).(x_b-x_a)/8, which
+ * is exact for quadratic fields with exact gradients.
+ */
+template <typename T>
+Omega_h::Reals edge_midpoint_values(Omega_h::Mesh& mesh,
+                                    const std::string& name)
+{
+  PCMS_FUNCTION_TIMER;
+  const LO nedges = mesh.nents(1);
+  Omega_h::Write<Real> values(nedges);
+  if (mesh.has_tag(1, name)) {
+    auto edge_values = mesh.template get_array<T>(1, name);
+    Omega_h::parallel_for(
+      nedges, OMEGA_H_LAMBDA(LO i) { values[i] = edge_values[i]; });
+    return values;
+  }
+  auto vertex_values = mesh.template get_array<T>(0, name);
+  const auto coords = mesh.coords();
+  const auto tris2verts = mesh.ask_elem_verts();
+  const LO nverts = mesh.nverts();
+  Omega_h::Write<Real> gradients(2 * nverts, 0);
+  Omega_h::Write<Real> areas(nverts, 0);
+  Omega_h::parallel_for(
+    mesh.nelems(), OMEGA_H_LAMBDA(LO elem_idx) {
+      const auto elem_tri2verts =
+        Omega_h::gather_verts<3>(tris2verts, elem_idx);
+      const auto vertex_coords =
+        Omega_h::gather_vectors<3, 2>(coords, elem_tri2verts);
+      const auto basis = Omega_h::simplex_basis<2, 2>(vertex_coords);
+      const Real u0 = vertex_values[elem_tri2verts[0]];
+      const Real u1 = vertex_values[elem_tri2verts[1]];
+      const Real u2 = vertex_values[elem_tri2verts[2]];
+      const Omega_h::Vector<2> du{u1 - u0, u2 - u0};
+      const auto gradient =
+        Omega_h::transpose(Omega_h::pseudo_invert(basis)) * du;
+      const Real area = std::abs(Omega_h::determinant(basis)) / 2;
+      for (int j = 0; j < 3; ++j) {
+        const auto vert = elem_tri2verts[j];
+        Kokkos::atomic_add(&gradients[2 * vert], area * gradient[0]);
+        Kokkos::atomic_add(&gradients[2 * vert + 1], area * gradient[1]);
+        Kokkos::atomic_add(&areas[vert], area);
+      }
+    });
+  const auto edges2verts = mesh.ask_verts_of(1);
+  Omega_h::parallel_for(
+    nedges, OMEGA_H_LAMBDA(LO edge) {
+      const auto a = edges2verts[2 * edge];
+      const auto b = edges2verts[2 * edge + 1];
+      const Real ua = vertex_values[a];
+      const Real ub = vertex_values[b];
+      Real correction = 0;
+      if (areas[a] > 0 && areas[b] > 0) {
+        for (int d = 0; d < 2; ++d) {
+          const Real dg =
+            gradients[2 * b + d] / areas[b] - gradients[2 * a + d] / areas[a];
+          correction += dg * (coords[2 * b + d] - coords[2 * a + d]);
+        }
+      }
+      values[edge] = (ua + ub) / 2 - correction / 8;
     });
   return values;
 }
 
+// values that the interpolation operator columns refer to. These are the
+// values at all (unmasked) vertices.
+template <typename T, typename CoordinateElementType, typename Method>
+auto interpolation_dofs(const OmegaHField<T, CoordinateElementType>& field,
+                        const Method& /* method */) -> Omega_h::Read<T>
+{
+  PCMS_FUNCTION_TIMER;
+  return field.GetMesh().template get_array<T>(0, field.GetName());
+}
+
+// the vertex values followed by the edge midpoint values
+template <typename T, typename CoordinateElementType>
+auto interpolation_dofs(const OmegaHField<T, CoordinateElementType>& field,
+                        const Lagrange<2>& /* method */) -> Omega_h::Reals
+{
+  PCMS_FUNCTION_TIMER;
+  auto& mesh = field.GetMesh();
+  auto vertex_values = mesh.template get_array<T>(0, field.GetName());
+  auto edge_values = edge_midpoint_values<T>(mesh, field.GetName());
+  const LO nverts = vertex_values.size();
+  Omega_h::Write<Real> dofs(nverts + edge_values.size());
+  Omega_h::parallel_for(
+    dofs.size(), OMEGA_H_LAMBDA(LO i) {
+      dofs[i] = (i < nverts) ? static_cast<Real>(vertex_values[i])
+                             : edge_values[i - nverts];
+    });
+  return dofs;
+}
+
+template <typename Field, typename Method, typename = void>
+struct HasInterpolationOperator : std::false_type
+{
+};
+template <typename Field, typename Method>
+struct HasInterpolationOperator<
+  Field, Method,
+  std::void_t<decltype(build_interpolation_operator(
+    std::declval<const Field&>(), std::declval<Method>(),
+    std::declval<ScalarArrayView<const typename Field::coordinate_element_type,
+                                 OmegaHMemorySpace::type>>()))>>
+  : std::true_type
+{
+};
+
+template <typename T, typename CoordinateElementType, typename Method>
+auto apply_interpolation_operator(
+  const OmegaHField<T, CoordinateElementType>& field,
+  const InterpolationOperator<OmegaHMemorySpace::type>& op,
+  const Method& method) -> Omega_h::Read<T>
+{
+  PCMS_FUNCTION_TIMER;
+  Omega_h::Write<T> values(op.NumRows());
+  auto dofs = interpolation_dofs(field, method);
+  op.Apply(make_const_array_view(dofs), make_array_view(values));
+  return values;
+}
+} // namespace detail
+
+template <typename T, typename CoordinateElementType>
+auto evaluate(
+  const OmegaHField<T, CoordinateElementType>& field, Lagrange<1> method,
+  ScalarArrayView<const CoordinateElementType, OmegaHMemorySpace::type>
+    coordinates) -> Omega_h::Read<T>
+{
+  PCMS_FUNCTION_TIMER;
+  return detail::apply_interpolation_operator(
+    field, detail::build_interpolation_operator(field, method, coordinates),
+    method);
+}
+
+template <typename T, typename CoordinateElementType>
+auto evaluate(
+  const OmegaHField<T, CoordinateElementType>& field, NearestNeighbor method,
+  ScalarArrayView<const CoordinateElementType, OmegaHMemorySpace::type>
+    coordinates) -> Omega_h::Read<T>
+{
+  PCMS_FUNCTION_TIMER;
+  return detail::apply_interpolation_operator(
+    field, detail::build_interpolation_operator(field, method, coordinates),
+    method);
+}
+
+/**
+ * Evaluate the quadratic Lagrange interpolant of the field. The vertex values
+ * come from the field and the edge midpoint values from a tag of the same name
+ * on the mesh edges, or are recovered from the vertex values if the mesh has
+ * no such tag (see detail::edge_midpoint_values).
+ */
+template <typename T, typename CoordinateElementType>
+auto evaluate(
+  const OmegaHField<T, CoordinateElementType>& field, Lagrange<2> method,
+  ScalarArrayView<const CoordinateElementType, OmegaHMemorySpace::type>
+    coordinates) -> Omega_h::Read<T>
+{
+  PCMS_FUNCTION_TIMER;
+  return detail::apply_interpolation_operator(
+    field, detail::build_interpolation_operator(field, method, coordinates),
+    method);
+}
+
+/**
+ * Mesh free evaluation of the field from its vertex values with a moving
+ * least squares fit (see build_mls_operator).
+ */
+template <typename T, typename CoordinateElementType>
+auto evaluate(
+  const OmegaHField<T, CoordinateElementType>& field,
+  MovingLeastSquares method,
+  ScalarArrayView<const CoordinateElementType, OmegaHMemorySpace::type>
+    coordinates) -> Omega_h::Read<T>
+{
+  PCMS_FUNCTION_TIMER;
+  return detail::apply_interpolation_operator(
+    field, detail::build_interpolation_operator(field, method, coordinates),
+    method);
+}
+
+/**
+ * Interpolation between two Omega_h fields. For methods that can be expressed
+ * as an InterpolationOperator, the operator is built on the first transfer to
+ * the target and cached on the source field, so later transfers skip the
+ * point search and only apply the sparse operator. The cache assumes the
+ * meshes do not move.
+ */
+template <typename T, typename U, typename CoordinateElementType,
+          typename EvaluationMethod = Lagrange<1>>
+void interpolate_field(const OmegaHField<T, CoordinateElementType>& source,
+                       OmegaHField<U, CoordinateElementType>& target,
+                       EvaluationMethod method = {})
+{
+  PCMS_FUNCTION_TIMER;
+  if constexpr (detail::HasInterpolationOperator<
+                  OmegaHField<T, CoordinateElementType>,
+                  EvaluationMethod>::value) {
+    const detail::InterpolationOperatorKey key{
+      target.GetMeshState(), target.GetMaskIdentity(), target.Size(), method};
+    const auto& op = source.GetInterpolationOperator(key, [&]() {
+      auto coordinates = get_nodal_coordinates(target);
+      return detail::build_interpolation_operator(
+        source, method, make_const_array_view(coordinates));
+    });
+    const auto data = detail::apply_interpolation_operator(source, op, method);
+    set_nodal_data(target, make_array_view(data));
+  } else {
+    auto coordinates = get_nodal_coordinates(target);
+    const auto data =
+      evaluate(source, method, make_const_array_view(coordinates));
+    set_nodal_data(target, make_array_view(data));
+  }
+}
+
+/**
+ * Conservative transfer between two Omega_h fields (see
+ * build_conservative_operator). The supermesh weights are computed on the
+ * first transfer to the target and cached on the source field. The candidate
+ * source triangles come from the source field's uniform grid search. If the
+ * field uses a different search, a temporary grid search is built.
+ */
+template <typename T, typename U, typename CoordinateElementType>
+void conservative_transfer(
+  const OmegaHField<T, CoordinateElementType>& source,
+  OmegaHField<U, CoordinateElementType>& target)
+{
+  PCMS_FUNCTION_TIMER;
+  const detail::InterpolationOperatorKey key{
+    target.GetMeshState(), target.GetMaskIdentity(), target.Size(),
+    Conservative{}};
+  const auto& op = source.GetInterpolationOperator(key, [&]() {
+    const auto* search =
+      source.HasSearch() ? std::get_if<GridPointSearch>(&source.GetSearch())
+                         : nullptr;
+    if (search != nullptr) {
+      return build_conservative_operator(source.GetMesh(), *search,
+                                         target.GetMesh(), target.GetMask(),
+                                         target.Size());
+    }
+    const GridPointSearch grid_search(source.GetMesh());
+    return build_conservative_operator(source.GetMesh(), grid_search,
+                                       target.GetMesh(), target.GetMask(),
+                                       target.Size());
+  });
+  const auto data =
+    detail::apply_interpolation_operator(source, op, Conservative{});
+  set_nodal_data(target, make_array_view(data));
+}
+
 template <typename T, typename Method, typename CoordinateElementType>
 auto evaluate(
   const OmegaHField<T, CoordinateElementType>& field, Method&& m,
@@ -469,34 +1192,105 @@ public:
   {
     return field_.GetName();
   }
-  // REQUIRED
+  /**
+   * REQUIRED
+   * Gathers buffer[i] = data[permutation[i]] where data is the masked field.
+   * Masking and permutation are fused into one kernel that reads the vertex
+   * tag through a cached index, so no filtered copy of the field is made. The
+   * kernel writes directly into the buffer if it is accessible from the
+   * execution space and otherwise into a pinned staging buffer. An empty
+   * buffer queries the size without any work.
+   */
   int Serialize(ScalarArrayView<T, pcms::HostMemorySpace> buffer,
                 ScalarArrayView<const pcms::LO, pcms::HostMemorySpace>
                   permutation) const
   {
     PCMS_FUNCTION_TIMER;
-    // host copy of filtered field data array
-    const auto array_h = Omega_h::HostRead<T>(get_nodal_data(field_));
-    if (buffer.size() > 0) {
-      for (LO i = 0; i < array_h.size(); i++) {
-        buffer[i] = array_h[permutation[i]];
+    const LO n = field_.Size();
+    if (buffer.size() == 0) {
+      return n;
+    }
+    PCMS_ALWAYS_ASSERT(static_cast<LO>(buffer.size()) == n);
+    const auto gather_index = GatherIndex(permutation);
+    const auto data =
+      field_.GetMesh().template get_array<T>(0, field_.GetName());
+    using execution_space = typename memory_space::execution_space;
+    constexpr bool buffer_accessible =
+      Kokkos::SpaceAccessibility<execution_space, HostMemorySpace>::accessible;
+    constexpr bool pinned_accessible =
+      Kokkos::SpaceAccessibility<execution_space,
+                                 HostPinnedMemorySpace>::accessible;
+    T* output = buffer.data_handle();
+    Kokkos::View<T*, memory_space> packed;
+    if constexpr (!buffer_accessible && pinned_accessible) {
+      if (static_cast<LO>(pinned_buffer_.size()) != n) {
+        pinned_buffer_ =
+          Kokkos::View<T*, HostPinnedMemorySpace>("pinned buffer", n);
       }
+      output = pinned_buffer_.data();
+    } else if constexpr (!buffer_accessible) {
+      packed = Kokkos::View<T*, memory_space>("packed", n);
+      output = packed.data();
     }
-    return array_h.size();
+    Kokkos::parallel_for(
+      Kokkos::RangePolicy<execution_space>(0, n),
+      KOKKOS_LAMBDA(LO i) { output[i] = data[gather_index(i)]; });
+    execution_space().fence();
+    if constexpr (!buffer_accessible && pinned_accessible) {
+      std::copy_n(pinned_buffer_.data(), n, buffer.data_handle());
+    } else if constexpr (!buffer_accessible) {
+      Kokkos::deep_copy(
+        Kokkos::View<T*, HostMemorySpace,
+                     Kokkos::MemoryTraits<Kokkos::Unmanaged>>(
+          buffer.data_handle(), n),
+        packed);
+    }
+    return n;
   }
-  // REQUIRED
+  /**
+   * REQUIRED
+   * Scatters data[permutation[i]] = buffer[i] into the masked field. The
+   * message is copied to the device once and the permutation and mask are
+   * applied in one kernel with the same index as Serialize. The kernel writes
+   * in place into a persistent array that backs the vertex tag, so repeated
+   * calls don't allocate. Unlike the usual Omega_h contract, a Read obtained
+   * from the tag (e.g. get_array or an unmasked get_nodal_data) is not a
+   * snapshot: it shares that storage and sees the values of later calls.
+   * Callers that need to keep the old values must deep_copy them. If the
+   * message is copied to
+   * the device, the kernel only reads the copy and is not fenced, so the
+   * caller can continue (e.g. end another receive phase) while it runs.
+   */
   void Deserialize(ScalarArrayView<const T, pcms::HostMemorySpace> buffer,
                    ScalarArrayView<const pcms::LO, pcms::HostMemorySpace>
                      permutation) const
   {
     PCMS_FUNCTION_TIMER;
-    REDEV_ALWAYS_ASSERT(buffer.size() == permutation.size());
-    Omega_h::HostWrite<T> sorted_buffer(buffer.size());
-    for (size_t i = 0; i < buffer.size(); ++i) {
-      sorted_buffer[permutation[i]] = buffer[i];
+    const LO n = field_.Size();
+    REDEV_ALWAYS_ASSERT(static_cast<LO>(buffer.size()) == n);
+    const auto scatter_index = GatherIndex(permutation);
+    auto tag_data = TagData();
+    using execution_space = typename memory_space::execution_space;
+    constexpr bool buffer_accessible =
+      Kokkos::SpaceAccessibility<execution_space, HostMemorySpace>::accessible;
+    const T* input = buffer.data_handle();
+    if constexpr (!buffer_accessible) {
+      if (static_cast<LO>(message_.size()) != n) {
+        message_ = Kokkos::View<T*, memory_space>("message", n);
+      }
+      Kokkos::deep_copy(
+        message_, Kokkos::View<const T*, HostMemorySpace,
+                               Kokkos::MemoryTraits<Kokkos::Unmanaged>>(
+                    buffer.data_handle(), n));
+      input = message_.data();
+    }
+    Kokkos::parallel_for(
+      Kokkos::RangePolicy<execution_space>(0, n),
+      KOKKOS_LAMBDA(LO i) { tag_data[scatter_index(i)] = input[i]; });
+    if constexpr (buffer_accessible) {
+      // the kernel reads the caller's buffer
+      execution_space().fence();
     }
-    const auto sorted_buffer_d = Omega_h::Read<T>(sorted_buffer);
-    set_nodal_data(field_, make_array_view(sorted_buffer_d));
   }
 
   [[nodiscard]] std::vector<GO> GetGids() const
@@ -512,21 +1306,64 @@ public:
   // REQUIRED
   [[nodiscard]] ReversePartitionMap GetReversePartitionMap(
     const redev::Partition& partition) const
+  {
+    PCMS_FUNCTION_TIMER;
+    const auto reverse_partition = GetReversePartition(partition);
+    pcms::ReversePartitionMap reverse_partition_map;
+    const auto indices = reverse_partition.indices.begin();
+    for (size_t r = 0; r < reverse_partition.ranks.size(); ++r) {
+      reverse_partition_map.emplace(
+        reverse_partition.ranks[r],
+        std::vector<pcms::LO>(indices + reverse_partition.offsets[r],
+                              indices + reverse_partition.offsets[r + 1]));
+    }
+    return reverse_partition_map;
+  }
+  /**
+   * The rank of each model entity is looked up in the partition once, through
+   * a table indexed by class dim and class id that spans the range of class
+   * ids of each dimension. The vertices are then grouped by rank with a
+   * counting sort (see MakeReversePartition).
+   */
+  [[nodiscard]] ReversePartition GetReversePartition(
+    const redev::Partition& partition) const
   {
     PCMS_FUNCTION_TIMER;
     auto classIds_h = Omega_h::HostRead<Omega_h::ClassId>(field_.GetClassIDs());
     auto classDims_h = Omega_h::HostRead<Omega_h::I8>(field_.GetClassDims());
-
-    // local_index number of vertices going to each destination process by
-    // calling getRank - degree array
-    pcms::ReversePartitionMap reverse_partition;
-    pcms::LO local_index = 0;
-    for (auto i = 0; i < classIds_h.size(); i++) {
-      auto dr = std::visit(detail::GetRankOmegaH{i, classDims_h, classIds_h},
-                           partition);
-      reverse_partition[dr].emplace_back(local_index++);
+    const LO n = classIds_h.size();
+    // model entities have dimension 0 to 3
+    static constexpr int num_dims = 4;
+    std::array<Omega_h::ClassId, num_dims> min_id;
+    std::array<Omega_h::ClassId, num_dims> max_id;
+    min_id.fill(std::numeric_limits<Omega_h::ClassId>::max());
+    max_id.fill(std::numeric_limits<Omega_h::ClassId>::lowest());
+    for (LO i = 0; i < n; ++i) {
+      const auto dim = classDims_h[i];
+      PCMS_ALWAYS_ASSERT(dim >= 0 && dim < num_dims);
+      min_id[dim] = std::min(min_id[dim], classIds_h[i]);
+      max_id[dim] = std::max(max_id[dim], classIds_h[i]);
+    }
+    std::array<size_t, num_dims + 1> table_offset{};
+    for (int dim = 0; dim < num_dims; ++dim) {
+      const size_t num_ids =
+        (max_id[dim] >= min_id[dim]) ? max_id[dim] - min_id[dim] + 1 : 0;
+      table_offset[dim + 1] = table_offset[dim] + num_ids;
     }
-    return reverse_partition;
+    // -1 marks model entities whose rank hasn't been looked up yet
+    std::vector<LO> entity_ranks(table_offset[num_dims], -1);
+    std::vector<LO> vertex_ranks(n);
+    for (LO i = 0; i < n; ++i) {
+      const auto dim = classDims_h[i];
+      auto& rank =
+        entity_ranks[table_offset[dim] + (classIds_h[i] - min_id[dim])];
+      if (rank < 0) {
+        rank = std::visit(detail::GetRankOmegaH{i, classDims_h, classIds_h},
+                          partition);
+      }
+      vertex_ranks[i] = rank;
+    }
+    return MakeReversePartition(vertex_ranks);
   }
   // NOT REQUIRED PART OF FieldAdapter interface
   [[nodiscard]] OmegaHField<T, CoordinateElementType>& GetField() noexcept
@@ -541,11 +1378,69 @@ public:
   }
 
 private:
+  // persistent array backing the vertex tag (see
+  // detail::OmegaHMeshState::GetTagArray)
+  Omega_h::Write<T> TagData() const
+  {
+    PCMS_FUNCTION_TIMER;
+    auto& mesh = field_.GetMesh();
+    const auto& name = field_.GetName();
+    if (!tag_data_.exists() || !mesh.has_tag(0, name) ||
+        mesh.template get_array<T>(0, name).data() != tag_data_.data()) {
+      tag_data_ = field_.GetMeshState()->template GetTagArray<T>(mesh, name);
+    }
+    return tag_data_;
+  }
+  // mesh vertex of each buffer entry, used as the gather index by Serialize
+  // and the scatter index by Deserialize. Rebuilt when the permutation
+  // changes.
+  const Kokkos::View<LO*, memory_space>& GatherIndex(
+    ScalarArrayView<const pcms::LO, pcms::HostMemorySpace> permutation) const
+  {
+    PCMS_FUNCTION_TIMER;
+    const LO n = field_.Size();
+    const LO* begin = permutation.data_handle();
+    const bool changed =
+      static_cast<LO>(gather_index_.size()) != n ||
+      gather_permutation_.size() != permutation.size() ||
+      !std::equal(begin, begin + permutation.size(),
+                  gather_permutation_.begin());
+    if (changed) {
+      PCMS_ALWAYS_ASSERT(permutation.empty() ||
+                         static_cast<LO>(permutation.size()) == n);
+      gather_permutation_.assign(begin, begin + permutation.size());
+      const auto vertex_ids =
+        detail::filtered_vertex_ids(field_.GetMask(), n);
+      Kokkos::View<LO*, memory_space> gather_index("gather index", n);
+      if (permutation.empty()) {
+        Kokkos::parallel_for(
+          n, KOKKOS_LAMBDA(LO i) { gather_index(i) = vertex_ids[i]; });
+      } else {
+        const auto permutation_d = Kokkos::create_mirror_view_and_copy(
+          memory_space{},
+          Kokkos::View<const LO*, HostMemorySpace,
+                       Kokkos::MemoryTraits<Kokkos::Unmanaged>>(begin, n));
+        Kokkos::parallel_for(
+          n, KOKKOS_LAMBDA(LO i) {
+            gather_index(i) = vertex_ids[permutation_d(i)];
+          });
+      }
+      gather_index_ = gather_index;
+    }
+    return gather_index_;
+  }
+
   OmegaHField<T, CoordinateElementType> field_;
+  mutable std::vector<LO> gather_permutation_;
+  mutable Kokkos::View<LO*, memory_space> gather_index_;
+  mutable Kokkos::View<T*, HostPinnedMemorySpace> pinned_buffer_;
+  // device copy of the received message
+  mutable Kokkos::View<T*, memory_space> message_;
+  mutable Omega_h::Write<T> tag_data_;
 };
 template <typename FieldAdapter>
 void ConvertFieldAdapterToOmegaH(const FieldAdapter& adapter,
-                                 InternalField internal,
+                                 InternalField& internal,
                                  FieldTransferMethod ftm,
                                  FieldEvaluationMethod fem)
 {
@@ -573,7 +1468,7 @@ void ConvertOmegaHToFieldAdapter(const InternalField& internal,
 // implemented on the OmegaHFieldClass which is owned by the field adapter
 template <typename T, typename C>
 void ConvertFieldAdapterToOmegaH(const OmegaHFieldAdapter<T, C>& adapter,
-                                 InternalField internal,
+                                 InternalField& internal,
                                  FieldTransferMethod ftm,
                                  FieldEvaluationMethod fem)
 {
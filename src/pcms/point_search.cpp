@@ -1,6 +1,12 @@
 #include "point_search.h"
 #include <Omega_h_mesh.hpp>
+#include <Kokkos_Sort.hpp>
+#include "pcms/assert.h"
+#include <algorithm>
 #include <bitset>
+#include <cmath>
+#include <cstdint>
+#include <limits>
 
 namespace pcms
 {
@@ -140,10 +146,10 @@ bool triangle_intersects_bbox(const Omega_h::Matrix<2, 3>& coords,
 namespace detail
 {
 /**
- *  Functor for constructing the mapping from grid cells to intersecting
- * triangles. Each row of the resulting CSR structure represents a grid cell and
- * each row entry corresponds to an ID of an element that intersects that grid
- * cell.
+ * Functor for constructing the mapping from grid cells to intersecting
+ * triangles. Rather than testing every triangle against every grid cell, each
+ * triangle only tests the grid cells that its bounding box overlaps, so the
+ * cost scales with the number of actual intersections.
  * \Warning since this works on Omega_h meshes, we currently assume each element
  * is a 2D simplex (triangle)
  * \Warning since this uses Omega_h data which is only available in the
@@ -152,48 +158,54 @@ namespace detail
 struct GridTriIntersectionFunctor
 {
   GridTriIntersectionFunctor(Omega_h::Mesh& mesh, Kokkos::View<UniformGrid[1]> grid)
-    : mesh_(mesh),
-      tris2verts_(mesh_.ask_elem_verts()),
-      coords_(mesh_.coords()),
-      grid_(grid),
-      nelems_(mesh_.nelems())
+    : tris2verts_(mesh.ask_elem_verts()),
+      coords_(mesh.coords()),
+      grid_(grid)
   {
-    if (mesh_.dim() != 2) {
+    if (mesh.dim() != 2) {
       std::cerr << "GridTriIntersection currently only developed for 2D "
                    "triangular meshes\n";
       std::terminate();
     }
   }
-  /// Two-pass functor. On the first pass we set the number of grid/triangle
-  /// intersections. On the second pass we fill the CSR array with the indexes
-  /// to the triangles intersecting with the current grid cell (row)
-  KOKKOS_INLINE_FUNCTION
-  LO operator()(LO row, LO* fill) const
+  /// call func(cell_id) for every grid cell that intersects the triangle
+  template <typename Func>
+  KOKKOS_INLINE_FUNCTION void ForEachIntersectingCell(LO elem_idx,
+                                                      const Func& func) const
   {
-    const auto grid_cell_bbox = grid_(0).GetCellBBOX(row);
-    LO num_intersections = 0;
-    // hierarchical parallel may make be very beneficial here...
-    for (LO elem_idx = 0; elem_idx < nelems_; ++elem_idx) {
-      const auto elem_tri2verts = Omega_h::gather_verts<3>(tris2verts_, elem_idx);
-      // 2d mesh with 2d coords, but 3 triangles
-      const auto vertex_coords = Omega_h::gather_vectors<3, 2>(coords_, elem_tri2verts);
-      if (triangle_intersects_bbox(vertex_coords, grid_cell_bbox)) {
-        if (fill) {
-          fill[num_intersections] = elem_idx;
+    const auto& grid = grid_(0);
+    const auto elem_tri2verts = Omega_h::gather_verts<3>(tris2verts_, elem_idx);
+    // 2d mesh with 2d coords, but 3 triangles
+    const auto vertex_coords =
+      Omega_h::gather_vectors<3, 2>(coords_, elem_tri2verts);
+    const auto bbox = triangle_bbox(vertex_coords);
+    const auto lower = grid.ClosestTwoDCellIndex(
+      {bbox.center[0] - bbox.half_width[0], bbox.center[1] - bbox.half_width[1]});
+    const auto upper = grid.ClosestTwoDCellIndex(
+      {bbox.center[0] + bbox.half_width[0], bbox.center[1] + bbox.half_width[1]});
+    // grow the range by one cell since triangles that touch a cell boundary
+    // intersect the neighboring cell. The exact test below removes any cells
+    // that don't intersect.
+    const LO row_begin = (lower[0] > 0) ? lower[0] - 1 : 0;
+    const LO row_end =
+      (upper[0] < grid.divisions[1] - 1) ? upper[0] + 1 : grid.divisions[1] - 1;
+    const LO col_begin = (lower[1] > 0) ? lower[1] - 1 : 0;
+    const LO col_end =
+      (upper[1] < grid.divisions[0] - 1) ? upper[1] + 1 : grid.divisions[0] - 1;
+    for (LO i = row_begin; i <= row_end; ++i) {
+      for (LO j = col_begin; j <= col_end; ++j) {
+        const auto cell_id = grid.GetCellIndex(i, j);
+        if (triangle_intersects_bbox(vertex_coords, grid.GetCellBBOX(cell_id))) {
+          func(cell_id);
         }
-        ++num_intersections;
       }
     }
-    return num_intersections;
   }
 
 private:
-  Omega_h::Mesh& mesh_;
   Omega_h::LOs tris2verts_;
   Omega_h::Reals coords_;
   Kokkos::View<UniformGrid[1]> grid_;
-public:
-  LO nelems_;
 };
 
 // num_grid_cells should be result of grid.GetNumCells(), take as argument to avoid extra copy
@@ -201,9 +213,56 @@ public:
 Kokkos::Crs<LO, Kokkos::DefaultExecutionSpace, void, LO>
 construct_intersection_map(Omega_h::Mesh& mesh, Kokkos::View<UniformGrid[1]> grid, int num_grid_cells)
 {
+  const auto f = detail::GridTriIntersectionFunctor{mesh, grid};
+  const LO nelems = mesh.nelems();
+  // count the number of triangles that intersect each grid cell
+  Kokkos::View<LO*> counts("intersection counts", num_grid_cells);
+  Kokkos::parallel_for(
+    nelems, KOKKOS_LAMBDA(LO elem_idx) {
+      f.ForEachIntersectingCell(elem_idx, [&](LO cell_id) {
+        Kokkos::atomic_increment(&counts(cell_id));
+      });
+    });
+  Kokkos::View<LO*> row_map("intersection row map", num_grid_cells + 1);
+  Kokkos::parallel_scan(
+    num_grid_cells + 1, KOKKOS_LAMBDA(LO i, LO & update, bool final) {
+      const LO count = (i < num_grid_cells) ? counts(i) : 0;
+      if (final) {
+        row_map(i) = update;
+      }
+      update += count;
+    });
+  LO num_entries = 0;
+  Kokkos::deep_copy(num_entries,
+                    Kokkos::subview(row_map, num_grid_cells));
+  // fill the triangle ids, reusing counts as the fill position of each row
+  Kokkos::View<LO*> entries("intersection entries", num_entries);
+  Kokkos::deep_copy(counts, 0);
+  Kokkos::parallel_for(
+    nelems, KOKKOS_LAMBDA(LO elem_idx) {
+      f.ForEachIntersectingCell(elem_idx, [&](LO cell_id) {
+        const auto pos = Kokkos::atomic_fetch_add(&counts(cell_id), 1);
+        entries(row_map(cell_id) + pos) = elem_idx;
+      });
+    });
+  // the atomic fill order is nondeterministic. Sort each row so that searches
+  // always return the lowest id triangle that contains a point.
+  Kokkos::parallel_for(
+    num_grid_cells, KOKKOS_LAMBDA(LO row) {
+      const auto begin = row_map(row);
+      const auto end = row_map(row + 1);
+      for (LO i = begin + 1; i < end; ++i) {
+        const auto value = entries(i);
+        LO j = i;
+        for (; j > begin && entries(j - 1) > value; --j) {
+          entries(j) = entries(j - 1);
+        }
+        entries(j) = value;
+      }
+    });
   Kokkos::Crs<LO, Kokkos::DefaultExecutionSpace, void, LO> intersection_map{};
-  auto f = detail::GridTriIntersectionFunctor{mesh, grid};
-  Kokkos::count_and_fill_crs(intersection_map, num_grid_cells, f);
+  intersection_map.row_map = row_map;
+  intersection_map.entries = entries;
   return intersection_map;
 }
 } // namespace detail
@@ -220,6 +279,92 @@ Omega_h::Vector<3> barycentric_from_global(
   return {1 - xi[0] - xi[1], xi[0], xi[1]};
 }
 
+KOKKOS_FUNCTION
+Omega_h::Vector<3> closest_point_barycentric(
+  const Omega_h::Vector<2>& point, const Omega_h::Matrix<2, 3>& vertex_coords)
+{
+  // Ericson, Real-Time Collision Detection, section 5.1.5
+  const auto a = vertex_coords[0];
+  const auto b = vertex_coords[1];
+  const auto c = vertex_coords[2];
+  const auto ab = b - a;
+  const auto ac = c - a;
+  const auto ap = point - a;
+  const auto d1 = ab * ap;
+  const auto d2 = ac * ap;
+  if (d1 <= 0 && d2 <= 0) {
+    return {1, 0, 0};
+  }
+  const auto bp = point - b;
+  const auto d3 = ab * bp;
+  const auto d4 = ac * bp;
+  if (d3 >= 0 && d4 <= d3) {
+    return {0, 1, 0};
+  }
+  const auto vc = d1 * d4 - d3 * d2;
+  if (vc <= 0 && d1 >= 0 && d3 <= 0) {
+    const auto v = d1 / (d1 - d3);
+    return {1 - v, v, 0};
+  }
+  const auto cp = point - c;
+  const auto d5 = ab * cp;
+  const auto d6 = ac * cp;
+  if (d6 >= 0 && d5 <= d6) {
+    return {0, 0, 1};
+  }
+  const auto vb = d5 * d2 - d1 * d6;
+  if (vb <= 0 && d2 >= 0 && d6 <= 0) {
+    const auto w = d2 / (d2 - d6);
+    return {1 - w, 0, w};
+  }
+  const auto va = d3 * d6 - d5 * d4;
+  if (va <= 0 && (d4 - d3) >= 0 && (d5 - d6) >= 0) {
+    const auto w = (d4 - d3) / ((d4 - d3) + (d5 - d6));
+    return {0, 1 - w, w};
+  }
+  const auto denom = 1 / (va + vb + vc);
+  const auto v = vb * denom;
+  const auto w = vc * denom;
+  return {1 - v - w, v, w};
+}
+
+namespace detail
+{
+// squared distance from the point to the triangle and the barycentric
+// coordinates of the closest point
+KOKKOS_INLINE_FUNCTION
+Real distance_to_triangle_squared(const Omega_h::Vector<2>& point,
+                                  const Omega_h::Matrix<2, 3>& vertex_coords,
+                                  Omega_h::Vector<3>& parametric_coords)
+{
+  parametric_coords = closest_point_barycentric(point, vertex_coords);
+  Omega_h::Vector<2> closest = vertex_coords[0] * parametric_coords[0] +
+                               vertex_coords[1] * parametric_coords[1] +
+                               vertex_coords[2] * parametric_coords[2];
+  const auto diff = point - closest;
+  return diff * diff;
+}
+
+// keep the closer element. Elements at the same distance (e.g. sharing the
+// closest vertex) are ordered by id so the result is deterministic.
+KOKKOS_INLINE_FUNCTION
+void update_closest(LO elem_idx, Real distance,
+                    const Omega_h::Vector<3>& parametric_coords,
+                    LO& closest_elem, Real& closest_distance,
+                    Omega_h::Vector<3>& closest_coords)
+{
+  constexpr Real tolerance = 1E-12;
+  const Real scale = (closest_distance > 1) ? closest_distance : 1;
+  const bool tie = std::abs(distance - closest_distance) <= tolerance * scale;
+  if (closest_elem < 0 || (!tie && distance < closest_distance) ||
+      (tie && elem_idx < closest_elem)) {
+    closest_elem = elem_idx;
+    closest_distance = distance;
+    closest_coords = parametric_coords;
+  }
+}
+} // namespace detail
+
 template <int n,  typename Op>
 OMEGA_H_INLINE double myreduce(const Omega_h::Vector<n> & x, Op op) OMEGA_H_NOEXCEPT {
   auto out = x[0];
@@ -227,48 +372,565 @@ OMEGA_H_INLINE double myreduce(const Omega_h::Vector<n> & x, Op op) OMEGA_H_NOEX
   return out;
 }         
 
+namespace detail
+{
+InverseBasisView compute_inverse_bases(const Omega_h::LOs& tris2verts,
+                                       const Omega_h::Reals& coords,
+                                       LO num_elements)
+{
+  InverseBasisView inverse_bases("triangle inverse bases", num_elements);
+  Kokkos::parallel_for(
+    num_elements, KOKKOS_LAMBDA(LO elem_idx) {
+      const auto elem_tri2verts =
+        Omega_h::gather_verts<3>(tris2verts, elem_idx);
+      const auto vertex_coords =
+        Omega_h::gather_vectors<3, 2>(coords, elem_tri2verts);
+      const auto inverse_basis =
+        Omega_h::pseudo_invert(Omega_h::simplex_basis<2, 2>(vertex_coords));
+      inverse_bases(elem_idx, 0) = inverse_basis(0, 0);
+      inverse_bases(elem_idx, 1) = inverse_basis(0, 1);
+      inverse_bases(elem_idx, 2) = inverse_basis(1, 0);
+      inverse_bases(elem_idx, 3) = inverse_basis(1, 1);
+      inverse_bases(elem_idx, 4) = vertex_coords(0, 0);
+      inverse_bases(elem_idx, 5) = vertex_coords(1, 0);
+    });
+  return inverse_bases;
+}
+
+// barycentric coordinates of the point in the element. Uses the cached
+// inverse basis if it is available.
+KOKKOS_INLINE_FUNCTION
+Omega_h::Vector<3> element_barycentric(const InverseBasisView& inverse_bases,
+                                       const Omega_h::LOs& tris2verts,
+                                       const Omega_h::Reals& coords,
+                                       LO elem_idx,
+                                       const Omega_h::Vector<2>& point)
+{
+  if (inverse_bases.extent(0) > 0) {
+    const Real dx = point[0] - inverse_bases(elem_idx, 4);
+    const Real dy = point[1] - inverse_bases(elem_idx, 5);
+    const Real xi0 =
+      inverse_bases(elem_idx, 0) * dx + inverse_bases(elem_idx, 1) * dy;
+    const Real xi1 =
+      inverse_bases(elem_idx, 2) * dx + inverse_bases(elem_idx, 3) * dy;
+    return {1 - xi0 - xi1, xi0, xi1};
+  }
+  const auto elem_tri2verts = Omega_h::gather_verts<3>(tris2verts, elem_idx);
+  // 2d mesh with 2d coords, but 3 triangles
+  const auto vertex_coords =
+    Omega_h::gather_vectors<3, 2>(coords, elem_tri2verts);
+  return barycentric_from_global(point, vertex_coords);
+}
+
+struct GridSearchData
+{
+  Kokkos::View<UniformGrid[1]> grid;
+  Kokkos::Crs<LO, Kokkos::DefaultExecutionSpace, void, LO> candidate_map;
+  Omega_h::LOs tris2verts;
+  Omega_h::Reals coords;
+  InverseBasisView inverse_bases;
+};
+
+/**
+ * Lower bound on the squared distance from the point to the grid cells
+ * outside the first ring+1 rings around the center cell. Returns false if
+ * those rings already cover the whole grid.
+ */
+KOKKOS_INLINE_FUNCTION
+bool unsearched_distance_squared(const UniformGrid& grid,
+                                 const Omega_h::Vector<2>& point,
+                                 LO center_row, LO center_col, LO ring,
+                                 Real& distance_squared)
+{
+  const Real dx = grid.edge_length[0] / grid.divisions[0];
+  const Real dy = grid.edge_length[1] / grid.divisions[1];
+  // distance from the point to the region beyond each side of the searched
+  // block of cells. Sides that lie on the grid boundary have no cells beyond
+  // them.
+  bool unsearched = false;
+  Real distance = 0;
+  const auto update = [&](bool has_cells, Real side_distance) {
+    if (!has_cells) {
+      return;
+    }
+    side_distance = (side_distance > 0) ? side_distance : 0;
+    distance = (!unsearched || side_distance < distance) ? side_distance
+                                                         : distance;
+    unsearched = true;
+  };
+  update(center_col - ring > 0,
+         point[0] - (grid.bot_left[0] + (center_col - ring) * dx));
+  update(center_col + ring < grid.divisions[0] - 1,
+         grid.bot_left[0] + (center_col + ring + 1) * dx - point[0]);
+  update(center_row - ring > 0,
+         point[1] - (grid.bot_left[1] + (center_row - ring) * dy));
+  update(center_row + ring < grid.divisions[1] - 1,
+         grid.bot_left[1] + (center_row + ring + 1) * dy - point[1]);
+  distance_squared = distance * distance;
+  return unsearched;
+}
+
+/**
+ * Find the closest element to a point that is outside of the mesh. Rings of
+ * grid cells around the point's cell are searched until no cell outside the
+ * searched rings can be closer than the closest element found. Every element
+ * is a candidate in each cell it intersects, so an element closer than that
+ * bound would have been found in the searched rings.
+ */
+KOKKOS_INLINE_FUNCTION
+GridPointSearch::Result closest_element(const GridSearchData& data,
+                                        const Omega_h::Vector<2>& point)
+{
+  const auto& grid = data.grid(0);
+  const auto [center_row, center_col] = grid.ClosestTwoDCellIndex(point);
+  const LO nrows = grid.divisions[1];
+  const LO ncols = grid.divisions[0];
+  const LO max_ring = (nrows > ncols) ? nrows : ncols;
+  LO closest_elem = -1;
+  Real closest_distance = 0;
+  Omega_h::Vector<3> closest_coords{0, 0, 0};
+  for (LO ring = 0; ring <= max_ring; ++ring) {
+    for (LO i = center_row - ring; i <= center_row + ring; ++i) {
+      if (i < 0 || i >= nrows) {
+        continue;
+      }
+      for (LO j = center_col - ring; j <= center_col + ring; ++j) {
+        // only visit the cells on the border of the ring
+        const bool on_ring = (i == center_row - ring) ||
+                             (i == center_row + ring) ||
+                             (j == center_col - ring) || (j == center_col + ring);
+        if (j < 0 || j >= ncols || !on_ring) {
+          continue;
+        }
+        const auto cell_id = grid.GetCellIndex(i, j);
+        for (auto k = data.candidate_map.row_map(cell_id);
+             k < data.candidate_map.row_map(cell_id + 1); ++k) {
+          const auto elem_idx = data.candidate_map.entries(k);
+          const auto elem_tri2verts =
+            Omega_h::gather_verts<3>(data.tris2verts, elem_idx);
+          const auto vertex_coords =
+            Omega_h::gather_vectors<3, 2>(data.coords, elem_tri2verts);
+          Omega_h::Vector<3> parametric_coords;
+          const auto distance =
+            distance_to_triangle_squared(point, vertex_coords, parametric_coords);
+          update_closest(elem_idx, distance, parametric_coords, closest_elem,
+                         closest_distance, closest_coords);
+        }
+      }
+    }
+    Real unsearched_distance = 0;
+    if (!unsearched_distance_squared(grid, point, center_row, center_col, ring,
+                                     unsearched_distance)) {
+      break;
+    }
+    if (closest_elem >= 0 && unsearched_distance > closest_distance) {
+      break;
+    }
+  }
+  if (closest_elem < 0) {
+    return GridPointSearch::Result{-1, {0, 0, 0}};
+  }
+  return GridPointSearch::Result{encode_outside_element(closest_elem),
+                                 closest_coords};
+}
+
+KOKKOS_INLINE_FUNCTION
+GridPointSearch::Result scan_candidates(const GridSearchData& data,
+                                        const Omega_h::Vector<2>& point)
+{
+  auto cell_id = data.grid(0).ClosestCellID(point);
+  assert(cell_id < data.candidate_map.numRows() && cell_id >= 0);
+  auto candidates_begin = data.candidate_map.row_map(cell_id);
+  auto candidates_end = data.candidate_map.row_map(cell_id + 1);
+  // create array that's size of number of candidates x num coords to store
+  // parametric inversion
+  for (auto i = candidates_begin; i < candidates_end; ++i) {
+    auto parametric_coords =
+      element_barycentric(data.inverse_bases, data.tris2verts, data.coords,
+                          data.candidate_map.entries(i), point);
+    if (Omega_h::is_barycentric_inside(parametric_coords, fuzz)) {
+      return GridPointSearch::Result{data.candidate_map.entries(i),
+                                     parametric_coords};
+    }
+  }
+  return closest_element(data, point);
+}
+
+CandidateBlocks construct_candidate_blocks(
+  const Kokkos::Crs<LO, Kokkos::DefaultExecutionSpace, void, LO>& candidate_map,
+  const InverseBasisView& inverse_bases)
+{
+  constexpr int width = GridPointSearch::vector_scan_width;
+  const LO num_cells = candidate_map.numRows();
+  auto row_map = candidate_map.row_map;
+  auto entries = candidate_map.entries;
+  Kokkos::View<LO*> cell_block_offsets("candidate block offsets",
+                                       num_cells + 1);
+  Kokkos::parallel_scan(
+    num_cells + 1, KOKKOS_LAMBDA(LO i, LO & update, bool final) {
+      const LO num_blocks =
+        (i < num_cells) ? (row_map(i + 1) - row_map(i) + width - 1) / width
+                        : 0;
+      if (final) {
+        cell_block_offsets(i) = update;
+      }
+      update += num_blocks;
+    });
+  LO num_blocks = 0;
+  Kokkos::deep_copy(num_blocks,
+                    Kokkos::subview(cell_block_offsets, num_cells));
+  Kokkos::View<LO*> elems("candidate block elements", num_blocks * width);
+  Kokkos::View<Real*> coefficients("candidate block coefficients",
+                                   num_blocks * 6 * width);
+  const auto nan = std::numeric_limits<Real>::quiet_NaN();
+  Kokkos::parallel_for(
+    num_cells, KOKKOS_LAMBDA(LO cell) {
+      const auto begin = row_map(cell);
+      const auto num_candidates = row_map(cell + 1) - begin;
+      for (LO b = cell_block_offsets(cell); b < cell_block_offsets(cell + 1);
+           ++b) {
+        for (int lane = 0; lane < width; ++lane) {
+          const LO k = (b - cell_block_offsets(cell)) * width + lane;
+          const LO elem_idx = (k < num_candidates) ? entries(begin + k) : -1;
+          elems(b * width + lane) = elem_idx;
+          for (int component = 0; component < 6; ++component) {
+            Real value = (component < 4) ? 0 : nan;
+            if (elem_idx >= 0) {
+              value = inverse_bases(elem_idx, component);
+            }
+            coefficients((6 * b + component) * width + lane) = value;
+          }
+        }
+      }
+    });
+  return {cell_block_offsets, elems, coefficients};
+}
+
+/**
+ * Same result as scan_candidates, but all lanes of a block are tested before
+ * checking for a hit. The lane loops have no early exit or indirection so they
+ * can be vectorized.
+ */
+KOKKOS_INLINE_FUNCTION
+GridPointSearch::Result scan_candidate_blocks(const GridSearchData& data,
+                                              const CandidateBlocks& blocks,
+                                              const Omega_h::Vector<2>& point)
+{
+  constexpr int width = GridPointSearch::vector_scan_width;
+  const auto cell_id = data.grid(0).ClosestCellID(point);
+  for (LO b = blocks.cell_block_offsets(cell_id);
+       b < blocks.cell_block_offsets(cell_id + 1); ++b) {
+    const Real* coefficients = &blocks.coefficients(6 * b * width);
+    Real xi0[width];
+    Real xi1[width];
+    bool inside[width];
+    for (int lane = 0; lane < width; ++lane) {
+      const Real dx = point[0] - coefficients[4 * width + lane];
+      const Real dy = point[1] - coefficients[5 * width + lane];
+      xi0[lane] = coefficients[lane] * dx + coefficients[width + lane] * dy;
+      xi1[lane] =
+        coefficients[2 * width + lane] * dx + coefficients[3 * width + lane] * dy;
+      const Real xi2 = 1 - xi0[lane] - xi1[lane];
+      // NaN lanes compare false
+      inside[lane] = (xi0[lane] >= -fuzz) && (xi1[lane] >= -fuzz) &&
+                     (xi2 >= -fuzz) && (xi0[lane] <= 1 + fuzz) &&
+                     (xi1[lane] <= 1 + fuzz) && (xi2 <= 1 + fuzz);
+    }
+    for (int lane = 0; lane < width; ++lane) {
+      if (inside[lane]) {
+        return GridPointSearch::Result{
+          blocks.elems(b * width + lane),
+          {1 - xi0[lane] - xi1[lane], xi0[lane], xi1[lane]}};
+      }
+    }
+  }
+  return closest_element(data, point);
+}
+
+// first candidate in the grid cell of the point or -1 if the cell is empty
+KOKKOS_INLINE_FUNCTION
+LO grid_seed(const GridSearchData& data, const Omega_h::Vector<2>& point)
+{
+  auto cell_id = data.grid(0).ClosestCellID(point);
+  auto candidates_begin = data.candidate_map.row_map(cell_id);
+  auto candidates_end = data.candidate_map.row_map(cell_id + 1);
+  return (candidates_begin < candidates_end)
+           ? data.candidate_map.entries(candidates_begin)
+           : -1;
+}
+
+struct WalkData
+{
+  Omega_h::LOs tris2verts;
+  Omega_h::Reals coords;
+  Omega_h::LOs tris2edges;
+  Omega_h::LOs edges2tris_offsets;
+  Omega_h::LOs edges2tris;
+  LO max_steps;
+  InverseBasisView inverse_bases;
+};
+
+/**
+ * Visibility walk. At each step the point is tested against the current
+ * triangle and, if it lies outside, the walk crosses the edge opposite the
+ * vertex with the most negative barycentric coordinate. Returns false if the
+ * walk leaves the mesh or does not converge in max_steps.
+ */
+KOKKOS_INLINE_FUNCTION
+bool walk_to_point(const WalkData& data, const Omega_h::Vector<2>& point,
+                   LO start, GridPointSearch::Result& result)
+{
+  LO tri = start;
+  for (LO step = 0; step < data.max_steps; ++step) {
+    const auto parametric_coords = element_barycentric(
+      data.inverse_bases, data.tris2verts, data.coords, tri, point);
+    if (Omega_h::is_barycentric_inside(parametric_coords, fuzz)) {
+      result = GridPointSearch::Result{tri, parametric_coords};
+      return true;
+    }
+    int vert = 0;
+    for (int j = 1; j < 3; ++j) {
+      if (parametric_coords[j] < parametric_coords[vert]) {
+        vert = j;
+      }
+    }
+    // Omega_h triangle edge j connects vertices j and (j+1)%3, so the edge
+    // opposite vertex k is (k+1)%3
+    const LO edge = data.tris2edges[3 * tri + (vert + 1) % 3];
+    LO next = -1;
+    for (LO i = data.edges2tris_offsets[edge];
+         i < data.edges2tris_offsets[edge + 1]; ++i) {
+      if (data.edges2tris[i] != tri) {
+        next = data.edges2tris[i];
+      }
+    }
+    // boundary edge
+    if (next < 0) {
+      return false;
+    }
+    tri = next;
+  }
+  return false;
+}
+} // namespace detail
+
 Kokkos::View<GridPointSearch::Result*> GridPointSearch::operator()(Kokkos::View<Real*[dim] > points) const
+{
+  const LO npoints = points.extent(0);
+  if (!sort_queries_ || npoints < 2) {
+    return Search(points);
+  }
+  const auto permutation = detail::sort_points_by_cell(grid_, points);
+  Kokkos::View<Real* [dim]> sorted_points("sorted points", npoints);
+  Kokkos::parallel_for(
+    npoints, KOKKOS_LAMBDA(LO i) {
+      sorted_points(i, 0) = points(permutation(i), 0);
+      sorted_points(i, 1) = points(permutation(i), 1);
+    });
+  const auto sorted_results = Search(sorted_points);
+  Kokkos::View<Result*> results("point search result", npoints);
+  Kokkos::parallel_for(
+    npoints,
+    KOKKOS_LAMBDA(LO i) { results(permutation(i)) = sorted_results(i); });
+  return results;
+}
+
+Kokkos::View<GridPointSearch::Result*> GridPointSearch::Search(
+  Kokkos::View<Real* [dim]> points) const
+{
+  switch (query_mode_) {
+    case QueryMode::CandidateScan: return CandidateScan(points);
+    case QueryMode::Walk: return Walk(points);
+    case QueryMode::VectorizedScan: return VectorizedScan(points);
+      // no default case for compiler error on missing query mode
+  }
+  return {};
+}
+
+Kokkos::View<GridPointSearch::Result*> GridPointSearch::CandidateScan(Kokkos::View<Real*[dim] > points) const
 {
   static_assert(dim == 2, "point search assumes dim==2");
   Kokkos::View<GridPointSearch::Result*> results("point search result", points.extent(0));
-  auto num_rows = candidate_map_.numRows();
   // needed so that we don't capture this ptr which will be memory error on cuda
-  auto grid = grid_; 
-  auto candidate_map = candidate_map_;
-  auto tris2verts = tris2verts_;
-  auto coords = coords_;
+  const detail::GridSearchData data{grid_, candidate_map_, tris2verts_,
+                                    coords_, inverse_bases_};
   Kokkos::parallel_for(points.extent(0), KOKKOS_LAMBDA(int p) {
     Omega_h::Vector<2> point(std::initializer_list<double>{points(p,0), points(p,1)});
-    auto cell_id = grid(0).ClosestCellID(point);
-    assert(cell_id < num_rows && cell_id >= 0);
-    auto candidates_begin = candidate_map.row_map(cell_id);
-    auto candidates_end = candidate_map.row_map(cell_id + 1);
-    bool found = false;
-    // create array that's size of number of candidates x num coords to store
-    // parametric inversion
-    for (auto i = candidates_begin; i < candidates_end; ++i) {
-     auto elem_tri2verts =
-        Omega_h::gather_verts<3>(tris2verts, candidate_map.entries(i));
-      // 2d mesh with 2d coords, but 3 triangles
-     auto vertex_coords = Omega_h::gather_vectors<3, 2>(coords, elem_tri2verts);
-     auto parametric_coords = barycentric_from_global(point, vertex_coords);
-      if (Omega_h::is_barycentric_inside(parametric_coords, fuzz)) {
-        results(p) = GridPointSearch::Result{candidate_map.entries(i), parametric_coords};
-        found = true;
-        break;
-      }
-    }
-    if(!found)
-    {
-      results(p) = GridPointSearch::Result{-1,{0,0,0}};
-    }
+    results(p) = detail::scan_candidates(data, point);
   });
 
   return results;
 }
 
-GridPointSearch::GridPointSearch(Omega_h::Mesh& mesh, LO Nx, LO Ny)
+Kokkos::View<GridPointSearch::Result*> GridPointSearch::VectorizedScan(
+  Kokkos::View<Real* [dim]> points) const
+{
+  static_assert(dim == 2, "point search assumes dim==2");
+  if (candidate_blocks_.cell_block_offsets.extent(0) == 0) {
+    return CandidateScan(points);
+  }
+  Kokkos::View<Result*> results("point search result", points.extent(0));
+  const detail::GridSearchData data{grid_, candidate_map_, tris2verts_,
+                                    coords_, inverse_bases_};
+  const auto blocks = candidate_blocks_;
+  Kokkos::parallel_for(
+    points.extent(0), KOKKOS_LAMBDA(int p) {
+      Omega_h::Vector<2> point(
+        std::initializer_list<double>{points(p, 0), points(p, 1)});
+      results(p) = detail::scan_candidate_blocks(data, blocks, point);
+    });
+  return results;
+}
+
+void GridPointSearch::SetQueryMode(QueryMode mode)
+{
+  constexpr bool host_accessible =
+    Kokkos::SpaceAccessibility<
+      Kokkos::HostSpace,
+      Kokkos::DefaultExecutionSpace::memory_space>::accessible;
+  if (host_accessible && mode == QueryMode::VectorizedScan &&
+      candidate_blocks_.cell_block_offsets.extent(0) == 0) {
+    const auto inverse_bases =
+      HasInverseBasisCache()
+        ? inverse_bases_
+        : detail::compute_inverse_bases(tris2verts_, coords_,
+                                        tris2verts_.size() / 3);
+    candidate_blocks_ =
+      detail::construct_candidate_blocks(candidate_map_, inverse_bases);
+  }
+  query_mode_ = mode;
+}
+
+Kokkos::View<GridPointSearch::Result*> GridPointSearch::Walk(
+  Kokkos::View<Real* [dim]> points) const
+{
+  static_assert(dim == 2, "point search assumes dim==2");
+  const LO npoints = points.extent(0);
+  Kokkos::View<Result*> results("point search result", npoints);
+  const detail::GridSearchData data{grid_, candidate_map_, tris2verts_,
+                                    coords_, inverse_bases_};
+  const detail::WalkData walk_data{
+    tris2verts_,        coords_, tris2edges_, edges2tris_offsets_,
+    edges2tris_, 2 * (divisions_[0] + divisions_[1]) + 16,
+    inverse_bases_};
+  const LO nchunks = (npoints + walk_chunk_size - 1) / walk_chunk_size;
+  Kokkos::parallel_for(
+    nchunks, KOKKOS_LAMBDA(LO chunk) {
+      const LO begin = chunk * walk_chunk_size;
+      const LO end =
+        (begin + walk_chunk_size < npoints) ? begin + walk_chunk_size : npoints;
+      LO hint = -1;
+      for (LO p = begin; p < end; ++p) {
+        Omega_h::Vector<2> point(
+          std::initializer_list<double>{points(p, 0), points(p, 1)});
+        const LO start = (hint >= 0) ? hint : detail::grid_seed(data, point);
+        Result result{-1, {0, 0, 0}};
+        if (start < 0 || !detail::walk_to_point(walk_data, point, start, result)) {
+          result = detail::scan_candidates(data, point);
+        }
+        if (result.tri_id >= 0) {
+          hint = result.tri_id;
+        }
+        results(p) = result;
+      }
+    });
+  return results;
+}
+
+Kokkos::View<GridPointSearch::Result*> GridPointSearch::operator()(
+  Kokkos::View<Real* [dim]> points, Kokkos::View<const LO*> hints) const
+{
+  static_assert(dim == 2, "point search assumes dim==2");
+  PCMS_ALWAYS_ASSERT(hints.extent(0) == points.extent(0));
+  Kokkos::View<Result*> results("point search result", points.extent(0));
+  const detail::GridSearchData data{grid_, candidate_map_, tris2verts_,
+                                    coords_, inverse_bases_};
+  const detail::WalkData walk_data{
+    tris2verts_,        coords_, tris2edges_, edges2tris_offsets_,
+    edges2tris_, 2 * (divisions_[0] + divisions_[1]) + 16,
+    inverse_bases_};
+  Kokkos::parallel_for(
+    points.extent(0), KOKKOS_LAMBDA(int p) {
+      Omega_h::Vector<2> point(
+        std::initializer_list<double>{points(p, 0), points(p, 1)});
+      const LO start = (hints(p) >= 0) ? hints(p) : detail::grid_seed(data, point);
+      Result result{-1, {0, 0, 0}};
+      if (start < 0 || !detail::walk_to_point(walk_data, point, start, result)) {
+        result = detail::scan_candidates(data, point);
+      }
+      results(p) = result;
+    });
+  return results;
+}
+
+namespace detail
+{
+std::array<LO, 2> choose_grid_divisions(const std::array<Real, 2>& edge_length,
+                                        LO num_elements, Real elements_per_cell)
+{
+  PCMS_ALWAYS_ASSERT(elements_per_cell > 0);
+  const Real num_cells =
+    std::max(Real{1}, std::ceil(num_elements / elements_per_cell));
+  // degenerate (zero width) meshes get a single row/column of cells
+  if (edge_length[0] <= 0 || edge_length[1] <= 0) {
+    const auto n = static_cast<LO>(num_cells);
+    return {edge_length[0] > 0 ? n : 1, edge_length[1] > 0 ? n : 1};
+  }
+  // Nx/Ny = width/height gives square cells
+  const Real aspect = edge_length[0] / edge_length[1];
+  const auto nx =
+    std::max(LO{1}, static_cast<LO>(std::round(std::sqrt(num_cells * aspect))));
+  const auto ny = std::max(
+    LO{1}, static_cast<LO>(std::round(num_cells / static_cast<Real>(nx))));
+  return {nx, ny};
+}
+
+GridPointSearch::CandidateStatistics compute_candidate_statistics(
+  const Kokkos::Crs<LO, Kokkos::DefaultExecutionSpace, void, LO>& candidate_map)
 {
+  using MinMax = Kokkos::MinMax<LO, Kokkos::HostSpace>;
+  using MinMaxValue = typename MinMax::value_type;
+  const LO num_cells = candidate_map.numRows();
+  auto row_map = candidate_map.row_map;
+  MinMaxValue min_max;
+  Kokkos::parallel_reduce(
+    num_cells,
+    KOKKOS_LAMBDA(LO i, MinMaxValue & update) {
+      const LO num_candidates = row_map(i + 1) - row_map(i);
+      update.min_val =
+        (num_candidates < update.min_val) ? num_candidates : update.min_val;
+      update.max_val =
+        (num_candidates > update.max_val) ? num_candidates : update.max_val;
+    },
+    MinMax{min_max});
+  LO num_empty = 0;
+  Kokkos::parallel_reduce(
+    num_cells,
+    KOKKOS_LAMBDA(LO i, LO & update) {
+      update += (row_map(i + 1) == row_map(i));
+    },
+    num_empty);
+  LO num_entries = 0;
+  Kokkos::deep_copy(num_entries, Kokkos::subview(row_map, num_cells));
+  return {.num_cells = num_cells,
+          .num_empty_cells = num_empty,
+          .min_candidates = min_max.min_val,
+          .max_candidates = min_max.max_val,
+          .mean_candidates = static_cast<Real>(num_entries) / num_cells};
+}
+} // namespace detail
+
+GridPointSearch::GridPointSearch(Omega_h::Mesh& mesh, LO Nx, LO Ny,
+                                 bool cache_inverse_basis)
+  : GridPointSearch(mesh, std::array<LO, dim>{Nx, Ny}, cache_inverse_basis)
+{
+}
+
+GridPointSearch::GridPointSearch(Omega_h::Mesh& mesh,
+                                 std::array<LO, dim> divisions,
+                                 bool cache_inverse_basis)
+{
+  const auto [Nx, Ny] = divisions;
   auto mesh_bbox = Omega_h::get_bounding_box<2>(&mesh);
   auto grid_h = Kokkos::create_mirror_view(grid_);
   grid_h(0) = UniformGrid{.edge_length = {mesh_bbox.max[0] - mesh_bbox.min[0],
@@ -279,5 +941,413 @@ GridPointSearch::GridPointSearch(Omega_h::Mesh& mesh, LO Nx, LO Ny)
   candidate_map_ = detail::construct_intersection_map(mesh, grid_, grid_h(0).GetNumCells());
   coords_ = mesh.coords();
   tris2verts_ = mesh.ask_elem_verts();
+  divisions_ = divisions;
+  tris2edges_ = mesh.ask_down(2, 1).ab2b;
+  const auto edges2tris = mesh.ask_up(1, 2);
+  edges2tris_offsets_ = edges2tris.a2ab;
+  edges2tris_ = edges2tris.ab2b;
+  candidate_statistics_ = detail::compute_candidate_statistics(candidate_map_);
+  if (cache_inverse_basis) {
+    inverse_bases_ =
+      detail::compute_inverse_bases(tris2verts_, coords_, mesh.nelems());
+  }
+}
+
+GridPointSearch::GridPointSearch(Omega_h::Mesh& mesh)
+  : GridPointSearch(FromElementsPerCell(mesh, default_elements_per_cell))
+{
+}
+
+GridPointSearch GridPointSearch::FromElementsPerCell(Omega_h::Mesh& mesh,
+                                                     Real elements_per_cell,
+                                                     bool cache_inverse_basis)
+{
+  auto mesh_bbox = Omega_h::get_bounding_box<2>(&mesh);
+  return GridPointSearch(
+    mesh,
+    detail::choose_grid_divisions({mesh_bbox.max[0] - mesh_bbox.min[0],
+                                   mesh_bbox.max[1] - mesh_bbox.min[1]},
+                                  mesh.nelems(), elements_per_cell),
+    cache_inverse_basis);
+}
+
+namespace detail
+{
+KOKKOS_INLINE_FUNCTION
+int count_leading_zeros(std::uint32_t x)
+{
+  if (x == 0) {
+    return 32;
+  }
+  int n = 0;
+  if ((x & 0xFFFF0000u) == 0) { n += 16; x <<= 16; }
+  if ((x & 0xFF000000u) == 0) { n += 8; x <<= 8; }
+  if ((x & 0xF0000000u) == 0) { n += 4; x <<= 4; }
+  if ((x & 0xC0000000u) == 0) { n += 2; x <<= 2; }
+  if ((x & 0x80000000u) == 0) { n += 1; }
+  return n;
+}
+
+// spread the lower 16 bits of x so that there is a zero between each bit
+KOKKOS_INLINE_FUNCTION
+std::uint32_t expand_bits(std::uint32_t x)
+{
+  x &= 0x0000FFFFu;
+  x = (x | (x << 8)) & 0x00FF00FFu;
+  x = (x | (x << 4)) & 0x0F0F0F0Fu;
+  x = (x | (x << 2)) & 0x33333333u;
+  x = (x | (x << 1)) & 0x55555555u;
+  return x;
+}
+
+// 2D morton code of a point normalized to the unit square
+KOKKOS_INLINE_FUNCTION
+std::uint32_t morton_code(Real x, Real y)
+{
+  constexpr Real scale = 65536;
+  const auto quantize = [](Real v) {
+    v = (v < 0) ? 0 : v * scale;
+    return static_cast<std::uint32_t>((v > scale - 1) ? scale - 1 : v);
+  };
+  return expand_bits(quantize(x)) | (expand_bits(quantize(y)) << 1);
+}
+
+Kokkos::View<LO*> sort_points_by_cell(Kokkos::View<UniformGrid[1]> grid,
+                                      Kokkos::View<Real* [2]> points)
+{
+  const LO npoints = points.extent(0);
+  Kokkos::View<std::uint32_t*> codes("query morton codes", npoints);
+  Kokkos::parallel_for(
+    npoints, KOKKOS_LAMBDA(LO p) {
+      Omega_h::Vector<2> point(
+        std::initializer_list<double>{points(p, 0), points(p, 1)});
+      const auto [row, col] = grid(0).ClosestTwoDCellIndex(point);
+      codes(p) = expand_bits(col) | (expand_bits(row) << 1);
+    });
+  using MinMax = Kokkos::MinMax<std::uint32_t, Kokkos::HostSpace>;
+  using MinMaxValue = typename MinMax::value_type;
+  MinMaxValue code_range;
+  Kokkos::parallel_reduce(
+    npoints,
+    KOKKOS_LAMBDA(LO i, MinMaxValue & update) {
+      update.min_val = (codes(i) < update.min_val) ? codes(i) : update.min_val;
+      update.max_val = (codes(i) > update.max_val) ? codes(i) : update.max_val;
+    },
+    MinMax{code_range});
+  Kokkos::View<LO*> permutation("query permutation", npoints);
+  if (npoints == 0 || code_range.min_val == code_range.max_val) {
+    Kokkos::parallel_for(
+      npoints, KOKKOS_LAMBDA(LO i) { permutation(i) = i; });
+    return permutation;
+  }
+  using KeyView = Kokkos::View<std::uint32_t*>;
+  using BinOp = Kokkos::BinOp1D<KeyView>;
+  // at most one bin per cell code. The points within a bin are not sorted.
+  const auto num_bins = static_cast<int>(
+    std::min<std::uint32_t>(code_range.max_val - code_range.min_val + 1,
+                            static_cast<std::uint32_t>(npoints)));
+  Kokkos::BinSort<KeyView, BinOp> sorter(
+    codes, BinOp(num_bins, code_range.min_val, code_range.max_val), false);
+  sorter.create_permute_vector();
+  auto permute = sorter.get_permute_vector();
+  Kokkos::parallel_for(
+    npoints, KOKKOS_LAMBDA(LO i) { permutation(i) = permute(i); });
+  return permutation;
+}
+
+// length of the common prefix of the sorted codes i and j. Duplicate codes
+// are disambiguated by their index (Karras 2012, section 4)
+KOKKOS_INLINE_FUNCTION
+int common_prefix(const Kokkos::View<std::uint32_t*>& codes, LO n, LO i, LO j)
+{
+  if (j < 0 || j >= n) {
+    return -1;
+  }
+  const auto a = codes(i);
+  const auto b = codes(j);
+  if (a == b) {
+    return 32 + count_leading_zeros(static_cast<std::uint32_t>(i) ^
+                                    static_cast<std::uint32_t>(j));
+  }
+  return count_leading_zeros(a ^ b);
+}
+
+KOKKOS_INLINE_FUNCTION
+bool bbox_contains(const Kokkos::View<Real* [4]>& bboxes, LO node, Real x,
+                   Real y)
+{
+  return x >= bboxes(node, 0) && y >= bboxes(node, 1) &&
+         x <= bboxes(node, 2) && y <= bboxes(node, 3);
+}
+
+KOKKOS_INLINE_FUNCTION
+Real bbox_distance_squared(const Kokkos::View<Real* [4]>& bboxes, LO node,
+                           Real x, Real y)
+{
+  const Real dx = (x < bboxes(node, 0))   ? bboxes(node, 0) - x
+                  : (x > bboxes(node, 2)) ? x - bboxes(node, 2)
+                                          : 0;
+  const Real dy = (y < bboxes(node, 1))   ? bboxes(node, 1) - y
+                  : (y > bboxes(node, 3)) ? y - bboxes(node, 3)
+                                          : 0;
+  return dx * dx + dy * dy;
+}
+} // namespace detail
+
+BVHPointSearch::BVHPointSearch(Omega_h::Mesh& mesh)
+  : num_elems_(mesh.nelems()),
+    tris2verts_(mesh.ask_elem_verts()),
+    coords_(mesh.coords())
+{
+  if (mesh.dim() != 2) {
+    std::cerr << "BVHPointSearch currently only developed for 2D "
+                 "triangular meshes\n";
+    std::terminate();
+  }
+  const LO n = num_elems_;
+  PCMS_ALWAYS_ASSERT(n > 0);
+  const LO num_nodes = 2 * n - 1;
+  const LO leaf_offset = n - 1;
+  node_bboxes_ = Kokkos::View<Real* [4]>("bvh bboxes", num_nodes);
+  children_ = Kokkos::View<LO* [2]>("bvh children", n - 1);
+  leaf_elems_ = Kokkos::View<LO*>("bvh leaf elements", n);
+  auto tris2verts = tris2verts_;
+  auto coords = coords_;
+  const auto mesh_bbox = Omega_h::get_bounding_box<2>(&mesh);
+  const Real width = mesh_bbox.max[0] - mesh_bbox.min[0];
+  const Real height = mesh_bbox.max[1] - mesh_bbox.min[1];
+  const Real min_x = mesh_bbox.min[0];
+  const Real min_y = mesh_bbox.min[1];
+  // morton codes of the element bounding box centers
+  Kokkos::View<std::uint32_t*> codes("bvh morton codes", n);
+  Kokkos::parallel_for(
+    n, KOKKOS_LAMBDA(LO elem_idx) {
+      const auto elem_tri2verts =
+        Omega_h::gather_verts<3>(tris2verts, elem_idx);
+      const auto vertex_coords =
+        Omega_h::gather_vectors<3, 2>(coords, elem_tri2verts);
+      const auto bbox = triangle_bbox(vertex_coords);
+      const Real x = (width > 0) ? (bbox.center[0] - min_x) / width : 0;
+      const Real y = (height > 0) ? (bbox.center[1] - min_y) / height : 0;
+      codes(elem_idx) = detail::morton_code(x, y);
+    });
+  // sort the elements along the morton curve
+  using MinMax = Kokkos::MinMax<std::uint32_t, Kokkos::HostSpace>;
+  using MinMaxValue = typename MinMax::value_type;
+  MinMaxValue code_range;
+  Kokkos::parallel_reduce(
+    n,
+    KOKKOS_LAMBDA(LO i, MinMaxValue & update) {
+      update.min_val = (codes(i) < update.min_val) ? codes(i) : update.min_val;
+      update.max_val = (codes(i) > update.max_val) ? codes(i) : update.max_val;
+    },
+    MinMax{code_range});
+  auto leaf_elems = leaf_elems_;
+  if (code_range.min_val == code_range.max_val) {
+    Kokkos::parallel_for(
+      n, KOKKOS_LAMBDA(LO i) { leaf_elems(i) = i; });
+  } else {
+    using KeyView = Kokkos::View<std::uint32_t*>;
+    using BinOp = Kokkos::BinOp1D<KeyView>;
+    Kokkos::BinSort<KeyView, BinOp> sorter(
+      codes, BinOp(n, code_range.min_val, code_range.max_val), true);
+    sorter.create_permute_vector();
+    sorter.sort(codes);
+    auto permute = sorter.get_permute_vector();
+    Kokkos::parallel_for(
+      n, KOKKOS_LAMBDA(LO i) { leaf_elems(i) = permute(i); });
+  }
+  // leaf bounding boxes grown by the same relative tolerance used for the
+  // barycentric inside test
+  auto bboxes = node_bboxes_;
+  Kokkos::parallel_for(
+    n, KOKKOS_LAMBDA(LO i) {
+      const auto elem_tri2verts =
+        Omega_h::gather_verts<3>(tris2verts, leaf_elems(i));
+      const auto vertex_coords =
+        Omega_h::gather_vectors<3, 2>(coords, elem_tri2verts);
+      const auto bbox = triangle_bbox(vertex_coords);
+      const Real tol =
+        fuzz * 2 * std::fmax(bbox.half_width[0], bbox.half_width[1]);
+      bboxes(leaf_offset + i, 0) = bbox.center[0] - bbox.half_width[0] - tol;
+      bboxes(leaf_offset + i, 1) = bbox.center[1] - bbox.half_width[1] - tol;
+      bboxes(leaf_offset + i, 2) = bbox.center[0] + bbox.half_width[0] + tol;
+      bboxes(leaf_offset + i, 3) = bbox.center[1] + bbox.half_width[1] + tol;
+    });
+  if (n == 1) {
+    return;
+  }
+  // build the internal nodes, each node independently (Karras 2012, fig. 4)
+  Kokkos::View<LO*> parents("bvh parents", num_nodes);
+  auto children = children_;
+  Kokkos::parallel_for(
+    n - 1, KOKKOS_LAMBDA(LO i) {
+      const int d = (detail::common_prefix(codes, n, i, i + 1) -
+                     detail::common_prefix(codes, n, i, i - 1)) >= 0
+                      ? 1
+                      : -1;
+      // upper bound on the length of the range
+      const int min_prefix = detail::common_prefix(codes, n, i, i - d);
+      LO max_length = 2;
+      while (detail::common_prefix(codes, n, i, i + max_length * d) >
+             min_prefix) {
+        max_length *= 2;
+      }
+      // binary search for the other end of the range
+      LO length = 0;
+      for (LO t = max_length / 2; t >= 1; t /= 2) {
+        if (detail::common_prefix(codes, n, i, i + (length + t) * d) >
+            min_prefix) {
+          length += t;
+        }
+      }
+      const LO j = i + length * d;
+      // binary search for the split position
+      const int node_prefix = detail::common_prefix(codes, n, i, j);
+      LO split = 0;
+      for (LO div = 2;; div *= 2) {
+        const LO t = (length + div - 1) / div;
+        if (detail::common_prefix(codes, n, i, i + (split + t) * d) >
+            node_prefix) {
+          split += t;
+        }
+        if (t == 1) {
+          break;
+        }
+      }
+      const LO gamma = i + split * d + ((d < 0) ? -1 : 0);
+      const LO first = (i < j) ? i : j;
+      const LO last = (i < j) ? j : i;
+      const LO left = (first == gamma) ? leaf_offset + gamma : gamma;
+      const LO right = (last == gamma + 1) ? leaf_offset + gamma + 1 : gamma + 1;
+      children(i, 0) = left;
+      children(i, 1) = right;
+      parents(left) = i;
+      parents(right) = i;
+    });
+  // compute the internal bounding boxes bottom up. The second thread to reach
+  // a node computes its box, so both children are complete.
+  Kokkos::View<int*> visits("bvh visits", n - 1);
+  Kokkos::View<Real* [4], Kokkos::MemoryTraits<Kokkos::Atomic>> atomic_bboxes =
+    bboxes;
+  Kokkos::parallel_for(
+    n, KOKKOS_LAMBDA(LO i) {
+      LO node = parents(leaf_offset + i);
+      while (true) {
+        Kokkos::memory_fence();
+        if (Kokkos::atomic_fetch_add(&visits(node), 1) == 0) {
+          return;
+        }
+        Kokkos::memory_fence();
+        const LO left = children(node, 0);
+        const LO right = children(node, 1);
+        for (int k = 0; k < 2; ++k) {
+          const Real lo_left = atomic_bboxes(left, k);
+          const Real lo_right = atomic_bboxes(right, k);
+          const Real hi_left = atomic_bboxes(left, k + 2);
+          const Real hi_right = atomic_bboxes(right, k + 2);
+          atomic_bboxes(node, k) = (lo_left < lo_right) ? lo_left : lo_right;
+          atomic_bboxes(node, k + 2) = (hi_left > hi_right) ? hi_left : hi_right;
+        }
+        if (node == 0) {
+          return;
+        }
+        node = parents(node);
+      }
+    });
+}
+
+Kokkos::View<BVHPointSearch::Result*> BVHPointSearch::operator()(
+  Kokkos::View<Real* [dim]> points) const
+{
+  static_assert(dim == 2, "point search assumes dim==2");
+  Kokkos::View<Result*> results("point search result", points.extent(0));
+  // needed so that we don't capture this ptr which will be memory error on cuda
+  auto bboxes = node_bboxes_;
+  auto children = children_;
+  auto leaf_elems = leaf_elems_;
+  auto tris2verts = tris2verts_;
+  auto coords = coords_;
+  const LO leaf_offset = num_elems_ - 1;
+  Kokkos::parallel_for(
+    points.extent(0), KOKKOS_LAMBDA(int p) {
+      Omega_h::Vector<2> point(
+        std::initializer_list<double>{points(p, 0), points(p, 1)});
+      Result result{-1, {0, 0, 0}};
+      // the depth of the tree is bounded by the 64 bits of the morton code
+      // and index tie-break
+      constexpr int max_stack_size = 96;
+      LO stack[max_stack_size];
+      int stack_size = 0;
+      stack[stack_size++] = 0;
+      while (stack_size > 0) {
+        const LO node = stack[--stack_size];
+        if (!detail::bbox_contains(bboxes, node, point[0], point[1])) {
+          continue;
+        }
+        if (node >= leaf_offset) {
+          const LO elem_idx = leaf_elems(node - leaf_offset);
+          // keep the lowest id so results match the grid search
+          if (result.tri_id >= 0 && elem_idx > result.tri_id) {
+            continue;
+          }
+          const auto elem_tri2verts =
+            Omega_h::gather_verts<3>(tris2verts, elem_idx);
+          const auto vertex_coords =
+            Omega_h::gather_vectors<3, 2>(coords, elem_tri2verts);
+          const auto parametric_coords =
+            barycentric_from_global(point, vertex_coords);
+          if (Omega_h::is_barycentric_inside(parametric_coords, fuzz)) {
+            result = Result{elem_idx, parametric_coords};
+          }
+        } else {
+          assert(stack_size + 2 <= max_stack_size);
+          stack[stack_size++] = children(node, 1);
+          stack[stack_size++] = children(node, 0);
+        }
+      }
+      if (result.tri_id < 0) {
+        // nearest element query, pruning nodes farther than the best element
+        LO closest_elem = -1;
+        Real closest_distance = 0;
+        Omega_h::Vector<3> closest_coords{0, 0, 0};
+        stack_size = 0;
+        stack[stack_size++] = 0;
+        while (stack_size > 0) {
+          const LO node = stack[--stack_size];
+          if (closest_elem >= 0 &&
+              detail::bbox_distance_squared(bboxes, node, point[0], point[1]) >
+                closest_distance) {
+            continue;
+          }
+          if (node >= leaf_offset) {
+            const LO elem_idx = leaf_elems(node - leaf_offset);
+            const auto elem_tri2verts =
+              Omega_h::gather_verts<3>(tris2verts, elem_idx);
+            const auto vertex_coords =
+              Omega_h::gather_vectors<3, 2>(coords, elem_tri2verts);
+            Omega_h::Vector<3> parametric_coords;
+            const auto distance = detail::distance_to_triangle_squared(
+              point, vertex_coords, parametric_coords);
+            detail::update_closest(elem_idx, distance, parametric_coords,
+                                   closest_elem, closest_distance,
+                                   closest_coords);
+          } else {
+            // visit the closer child first so the pruning is effective
+            const LO left = children(node, 0);
+            const LO right = children(node, 1);
+            const bool left_first =
+              detail::bbox_distance_squared(bboxes, left, point[0], point[1]) <=
+              detail::bbox_distance_squared(bboxes, right, point[0], point[1]);
+            assert(stack_size + 2 <= max_stack_size);
+            stack[stack_size++] = left_first ? right : left;
+            stack[stack_size++] = left_first ? left : right;
+          }
+        }
+        result = Result{encode_outside_element(closest_elem), closest_coords};
+      }
+      results(p) = result;
+    });
+  return results;
 }
 } // namespace pcms
@@ -8,6 +8,8 @@
 #include <Omega_h_shape.hpp>
 #include "pcms/uniform_grid.h"
 #include "pcms/bounding_box.h"
+#include <array>
+#include <variant>
 
 namespace pcms
 {
@@ -18,6 +20,24 @@ namespace pcms
 namespace detail {
 Kokkos::Crs<LO, Kokkos::DefaultExecutionSpace, void, LO>
 construct_intersection_map(Omega_h::Mesh& mesh, Kokkos::View<UniformGrid[1]> grid, int num_grid_cells);
+using InverseBasisView = Kokkos::View<Real* [6], Kokkos::LayoutLeft>;
+/// permutation that orders the points along a Morton curve over the cells of
+/// the grid. Entry i is the index of the i-th point in Morton order.
+Kokkos::View<LO*> sort_points_by_cell(Kokkos::View<UniformGrid[1]> grid,
+                                      Kokkos::View<Real* [2]> points);
+/**
+ * Candidates of each grid cell stored contiguously in blocks of width
+ * candidates. Block b holds the inverse basis (0,0), (0,1), (1,0), (1,1) and
+ * origin x, y of its candidates in coefficients[(6*b+component)*width+lane]
+ * and the element ids in elems[b*width+lane]. Unused lanes have an id of -1
+ * and a NaN origin so they never contain a point.
+ */
+struct CandidateBlocks
+{
+  Kokkos::View<LO*> cell_block_offsets;
+  Kokkos::View<LO*> elems;
+  Kokkos::View<Real*> coefficients;
+};
 }
 KOKKOS_FUNCTION
 Omega_h::Vector<3> barycentric_from_global(
@@ -26,34 +46,235 @@ Omega_h::Vector<3> barycentric_from_global(
 [[nodiscard]] KOKKOS_FUNCTION bool triangle_intersects_bbox(
   const Omega_h::Matrix<2, 3>& coords, const AABBox<2>& bbox);
 
-class GridPointSearch
+/// barycentric coordinates of the point on the triangle closest to the input
+/// point. All coordinates are in [0,1].
+KOKKOS_FUNCTION
+Omega_h::Vector<3> closest_point_barycentric(
+  const Omega_h::Vector<2>& point, const Omega_h::Matrix<2, 3>& vertex_coords);
+
+/**
+ * Points that lie outside of the mesh are reported with the negative id
+ * -(id+1) of the closest element, so that element 0 can be distinguished from
+ * a point inside element 0.
+ */
+[[nodiscard]] KOKKOS_INLINE_FUNCTION LO encode_outside_element(LO id)
 {
-  using CandidateMapT = Kokkos::Crs<LO, Kokkos::DefaultExecutionSpace, void, LO>;
+  return -(id + 1);
+}
+/// id of the closest element for a negative search result
+[[nodiscard]] KOKKOS_INLINE_FUNCTION LO decode_outside_element(LO id)
+{
+  return -id - 1;
+}
 
+class GridPointSearch
+{
 public:
+  using CandidateMapT = Kokkos::Crs<LO, Kokkos::DefaultExecutionSpace, void, LO>;
   static constexpr auto dim = 2;
   struct Result {
     LO tri_id;
     Omega_h::Vector<dim + 1> parametric_coords;
   };
 
-  GridPointSearch(Omega_h::Mesh& mesh, LO Nx, LO Ny);
+  /// number of candidate elements in the grid cells
+  struct CandidateStatistics
+  {
+    LO num_cells;
+    LO num_empty_cells;
+    LO min_candidates;
+    LO max_candidates;
+    Real mean_candidates;
+  };
+  /// average number of elements per grid cell (by area) used to choose the
+  /// grid resolution automatically. The number of candidates per cell is
+  /// somewhat larger since elements that cross cell boundaries are candidates
+  /// in every cell they intersect.
+  static constexpr Real default_elements_per_cell = 4;
+
+  enum class QueryMode
+  {
+    /// test every candidate triangle in the grid cell of the point
+    CandidateScan,
+    /// walk across the triangle adjacencies starting from the result of the
+    /// previous point (or a grid seed). Fastest for coherent batches of
+    /// points such as the vertices of a target mesh. For points on an edge
+    /// shared by several triangles, the triangle found may differ from the
+    /// candidate scan.
+    Walk,
+    /// test the candidates of a cell in blocks of vector_scan_width stored
+    /// contiguously, so the compiler can vectorize the tests across a block.
+    /// Gives the same result as CandidateScan. This targets host backends
+    /// (Serial/OpenMP); on device backends CandidateScan is used instead.
+    VectorizedScan
+  };
+  /// number of consecutive points each thread handles in Walk mode. Each
+  /// point starts the walk from the triangle found for the previous one.
+  static constexpr LO walk_chunk_size = 32;
+  /// number of candidates tested together in VectorizedScan mode. Matches
+  /// the number of doubles in an AVX2 register.
+  static constexpr int vector_scan_width = 4;
+
+  /**
+   * If cache_inverse_basis is true, the inverse of the basis and the origin of
+   * each triangle are computed once during construction and the barycentric
+   * coordinates of a candidate reduce to a few multiply-adds. This costs
+   * 6 Reals of storage per triangle.
+   */
+  GridPointSearch(Omega_h::Mesh& mesh, LO Nx, LO Ny,
+                  bool cache_inverse_basis = false);
+  /**
+   * Construct the search with a grid resolution chosen from the number of
+   * elements and the aspect ratio of the mesh bounding box, so that each cell
+   * holds on average default_elements_per_cell elements. This keeps the query
+   * cost roughly constant as the mesh is refined.
+   */
+  explicit GridPointSearch(Omega_h::Mesh& mesh);
+  /**
+   * Same as GridPointSearch(mesh) with a chosen average number of elements per
+   * grid cell. This is a named function rather than a constructor so that it
+   * cannot be confused with the constructor that takes the divisions.
+   */
+  [[nodiscard]] static GridPointSearch FromElementsPerCell(
+    Omega_h::Mesh& mesh, Real elements_per_cell,
+    bool cache_inverse_basis = false);
+  [[nodiscard]] const CandidateStatistics& GetCandidateStatistics()
+    const noexcept
+  {
+    return candidate_statistics_;
+  }
+  [[nodiscard]] std::array<LO, dim> GetDivisions() const noexcept
+  {
+    return divisions_;
+  }
+  [[nodiscard]] const Kokkos::View<UniformGrid[1]>& GetGrid() const noexcept
+  {
+    return grid_;
+  }
+  /// triangles that intersect each grid cell, in ascending order
+  [[nodiscard]] const CandidateMapT& GetCandidateMap() const noexcept
+  {
+    return candidate_map_;
+  }
   /**
    *  given a point in global coordinates give the id of the triangle that the
    * point lies within and the parametric coordinate of the point within the
-   * triangle. If the point does not lie within any triangle element. Then the
-   * id will be a negative number and (TODO) will return a negative id of the
-   * closest element
+   * triangle. If the point does not lie within any triangle element, the id
+   * is the negative encoding (see encode_outside_element) of the closest
+   * element in the neighborhood of the point's grid cell and the parametric
+   * coordinates are those of the closest point on that element.
    */
   Kokkos::View<Result*> operator()(Kokkos::View<Real*[dim] > point) const;
+  /**
+   * Search where each point starts a walk from the triangle given in hints.
+   * Points with a negative hint are seeded from the grid. If a walk leaves
+   * the mesh or does not converge, the candidate scan is used for that point.
+   */
+  Kokkos::View<Result*> operator()(Kokkos::View<Real*[dim] > point,
+                                   Kokkos::View<const LO*> hints) const;
+  /// switching to VectorizedScan builds the candidate blocks on first use
+  void SetQueryMode(QueryMode mode);
+  [[nodiscard]] QueryMode GetQueryMode() const noexcept { return query_mode_; }
+  /**
+   * If enabled, the points are reordered along a Morton curve over the grid
+   * cells before the search and the results are returned in the input order.
+   * Neighboring threads then work on the same candidates and triangles, which
+   * improves cache reuse for large unordered batches of points. The
+   * reordering costs a sort and two permutations of the points.
+   */
+  void SetSortQueries(bool sort) noexcept { sort_queries_ = sort; }
+  [[nodiscard]] bool GetSortQueries() const noexcept { return sort_queries_; }
+  [[nodiscard]] bool HasInverseBasisCache() const noexcept
+  {
+    return inverse_bases_.extent(0) > 0;
+  }
 
 private:
+  GridPointSearch(Omega_h::Mesh& mesh, std::array<LO, dim> divisions,
+                  bool cache_inverse_basis);
+  // search the points in input order with the current query mode
+  Kokkos::View<Result*> Search(Kokkos::View<Real* [dim]> points) const;
+  Kokkos::View<Result*> CandidateScan(Kokkos::View<Real*[dim] > points) const;
+  Kokkos::View<Result*> Walk(Kokkos::View<Real*[dim] > points) const;
+  Kokkos::View<Result*> VectorizedScan(
+    Kokkos::View<Real* [dim]> points) const;
+
   Omega_h::Mesh mesh_;
   Kokkos::View<UniformGrid[1]> grid_{"uniform grid"};
   CandidateMapT candidate_map_;
   Omega_h::LOs tris2verts_;
   Omega_h::Reals coords_;
+  std::array<LO, dim> divisions_;
+  CandidateStatistics candidate_statistics_;
+  // adjacencies used by the walk
+  Omega_h::LOs tris2edges_;
+  Omega_h::LOs edges2tris_offsets_;
+  Omega_h::LOs edges2tris_;
+  QueryMode query_mode_ = QueryMode::CandidateScan;
+  bool sort_queries_ = false;
+  // per triangle (inverse basis (0,0), (0,1), (1,0), (1,1), origin x, y).
+  // LayoutLeft so each component is contiguous across the triangles. Empty
+  // when the cache is disabled.
+  detail::InverseBasisView inverse_bases_;
+  // only built for the VectorizedScan query mode
+  detail::CandidateBlocks candidate_blocks_;
+};
+
+/**
+ * Point search backed by a linear bounding volume hierarchy (LBVH) of the
+ * element bounding boxes. The tree is built in parallel by sorting the
+ * elements along a Morton curve and using the construction from Karras,
+ * "Maximizing Parallelism in the Construction of BVHs, Octrees, and k-d
+ * Trees" (HPG 2012). Unlike the uniform grid, the query cost is logarithmic
+ * in the number of elements independent of how strongly graded the mesh is.
+ */
+class BVHPointSearch
+{
+public:
+  static constexpr auto dim = GridPointSearch::dim;
+  using Result = GridPointSearch::Result;
+
+  explicit BVHPointSearch(Omega_h::Mesh& mesh);
+  /**
+   *  given a point in global coordinates give the id of the triangle that the
+   * point lies within and the parametric coordinate of the point within the
+   * triangle. If the point lies within several triangles (e.g. on an edge) the
+   * triangle with the lowest id is returned. If the point does not lie within
+   * any triangle element the id is the negative encoding (see
+   * encode_outside_element) of the closest element and the parametric
+   * coordinates are those of the closest point on that element.
+   */
+  Kokkos::View<Result*> operator()(Kokkos::View<Real*[dim] > point) const;
+  [[nodiscard]] LO GetNumElements() const noexcept { return num_elems_; }
+
+private:
+  LO num_elems_;
+  // internal nodes are [0, num_elems_-1), leaf k is node num_elems_-1+k
+  // bounding box of each node stored as (xmin, ymin, xmax, ymax)
+  Kokkos::View<Real* [4]> node_bboxes_;
+  Kokkos::View<LO* [2]> children_;
+  // element id of each leaf
+  Kokkos::View<LO*> leaf_elems_;
+  Omega_h::LOs tris2verts_;
+  Omega_h::Reals coords_;
+};
+
+enum class PointSearchMethod
+{
+  UniformGrid,
+  BVH
 };
 
+using PointSearch = std::variant<GridPointSearch, BVHPointSearch>;
+
+namespace detail
+{
+/// choose the number of grid divisions in x and y such that the cells are
+/// close to square and hold on average elements_per_cell elements
+[[nodiscard]] std::array<LO, 2> choose_grid_divisions(
+  const std::array<Real, 2>& edge_length, LO num_elements,
+  Real elements_per_cell);
+} // namespace detail
+
 } // namespace detail
 #endif // PCMS_COUPLING_POINT_SEARCH_H
@@ -4,8 +4,10 @@
 #include "pcms/field_communicator.h"
 #include "pcms/omega_h_field.h"
 #include "pcms/profile.h"
+#include <algorithm>
 #include <map>
 #include <typeinfo>
+#include <utility>
 
 namespace pcms
 {
@@ -45,6 +47,10 @@ public:
         name + ".__internal__", internal_mesh, internal_field_mask)}
   {
     PCMS_FUNCTION_TIMER;
+    // communicators that exchange data are constructed in place by the
+    // constructor below since pending receives refer to them by address
+    static_assert(std::is_move_constructible_v<FieldCommunicator<CommT>>,
+                  "only FieldCommunicator<void> can be passed in");
     coupled_field_ = std::make_unique<CoupledFieldModel<FieldAdapterT, CommT>>(
       std::move(field_adapter), std::move(field_comm),
       std::move(native_to_internal), std::move(internal_to_native));
@@ -55,7 +61,9 @@ public:
                           redev::Channel& channel, Omega_h::Mesh& internal_mesh,
                           TransferOptions native_to_internal,
                           TransferOptions internal_to_native,
-                          Omega_h::Read<Omega_h::I8> internal_field_mask)
+                          Omega_h::Read<Omega_h::I8> internal_field_mask,
+                          FieldLayoutCache* layout_cache = nullptr,
+                          std::string layout_name = "")
     : internal_field_{OmegaHField<typename FieldAdapterT::value_type,
                                   InternalCoordinateElement>(
         name + ".__internal__", internal_mesh, internal_field_mask)}
@@ -64,7 +72,8 @@ public:
     coupled_field_ =
       std::make_unique<CoupledFieldModel<FieldAdapterT, FieldAdapterT>>(
         name, std::move(field_adapter), mpi_comm, redev, channel,
-        std::move(native_to_internal), std::move(internal_to_native));
+        std::move(native_to_internal), std::move(internal_to_native),
+        layout_cache, std::move(layout_name));
   }
 
   void Send(Mode mode = Mode::Synchronous)
@@ -77,6 +86,12 @@ public:
     PCMS_FUNCTION_TIMER;
     coupled_field_->Receive(mode);
   }
+  /// post the receive and defer deserialization until Complete is called
+  [[nodiscard]] PendingReceive PostReceive(Mode mode = Mode::Deferred)
+  {
+    PCMS_FUNCTION_TIMER;
+    return coupled_field_->PostReceive(mode);
+  }
   void SyncNativeToInternal()
   {
     PCMS_FUNCTION_TIMER;
@@ -108,15 +123,40 @@ public:
     std::cerr << "Requested type does not match field adapter type\n";
     std::abort();
   }
+  /**
+   * create a communicator that sends/receives this field and the other fields
+   * as a single message. All fields must have the same value type and layout.
+   */
+  [[nodiscard]] FieldGroupCommunicator CreateFieldGroup(
+    std::string name, redev::Channel& channel,
+    const std::vector<ConvertibleCoupledField*>& fields) const
+  {
+    PCMS_FUNCTION_TIMER;
+    std::vector<CoupledFieldConcept*> coupled_fields;
+    coupled_fields.reserve(fields.size());
+    for (const auto* field : fields) {
+      coupled_fields.push_back(field->coupled_field_.get());
+    }
+    return coupled_field_->CreateFieldGroup(std::move(name), channel,
+                                            coupled_fields);
+  }
   struct CoupledFieldConcept
   {
     virtual void Send(Mode) = 0;
     virtual void Receive(Mode) = 0;
+    virtual PendingReceive PostReceive(Mode) = 0;
     virtual void SyncNativeToInternal(InternalField&) = 0;
     virtual void SyncInternalToNative(const InternalField&) = 0;
     [[nodiscard]] virtual const std::type_info& GetFieldAdapterType()
       const noexcept = 0;
     [[nodiscard]] virtual void* GetFieldAdapter() noexcept = 0;
+    // the field communicator as a detail::PackableField<value_type> or
+    // nullptr if the field does not communicate
+    [[nodiscard]] virtual detail::PackableFieldBase*
+    GetPackableField() noexcept = 0;
+    [[nodiscard]] virtual FieldGroupCommunicator CreateFieldGroup(
+      std::string, redev::Channel&,
+      const std::vector<CoupledFieldConcept*>&) const = 0;
     virtual ~CoupledFieldConcept() = default;
   };
   template <typename FieldAdapterT, typename CommT>
@@ -140,10 +180,12 @@ public:
                       MPI_Comm mpi_comm, redev::Redev& redev,
                       redev::Channel& channel,
                       TransferOptions&& native_to_internal,
-                      TransferOptions&& internal_to_native)
+                      TransferOptions&& internal_to_native,
+                      FieldLayoutCache* layout_cache, std::string layout_name)
       : field_adapter_(std::move(field_adapter)),
         comm_(FieldCommunicator<FieldAdapterT>(name, mpi_comm, redev, channel,
-                                               field_adapter_)),
+                                               field_adapter_, layout_cache,
+                                               std::move(layout_name))),
         native_to_internal_(std::move(native_to_internal)),
         internal_to_native_(std::move(internal_to_native)),
         type_info_(typeid(FieldAdapterT))
@@ -160,6 +202,11 @@ public:
       PCMS_FUNCTION_TIMER;
       comm_.Receive(mode);
     };
+    PendingReceive PostReceive(Mode mode) final
+    {
+      PCMS_FUNCTION_TIMER;
+      return comm_.PostReceive(mode);
+    };
     void SyncNativeToInternal(InternalField& internal_field) final
     {
       PCMS_FUNCTION_TIMER;
@@ -182,6 +229,27 @@ public:
     {
       return reinterpret_cast<void*>(&field_adapter_);
     };
+    [[nodiscard]] detail::PackableFieldBase* GetPackableField() noexcept final
+    {
+      if constexpr (std::is_void_v<CommT>) {
+        return nullptr;
+      } else {
+        return &comm_;
+      }
+    }
+    [[nodiscard]] FieldGroupCommunicator CreateFieldGroup(
+      std::string name, redev::Channel& channel,
+      const std::vector<CoupledFieldConcept*>& fields) const final
+    {
+      PCMS_FUNCTION_TIMER;
+      std::vector<detail::PackableFieldBase*> packable_fields;
+      packable_fields.reserve(fields.size());
+      for (auto* field : fields) {
+        packable_fields.push_back(field->GetPackableField());
+      }
+      return FieldGroupCommunicator::Create<value_type>(
+        std::move(name), channel, packable_fields);
+    }
 
     FieldAdapterT field_adapter_;
     FieldCommunicator<CommT> comm_;
@@ -210,12 +278,20 @@ public:
       redev_(redev),
       channel_{rdv.CreateAdiosChannel(std::move(name), std::move(params),
                                       transport_type, std::move(path))},
+      layout_cache_(comm),
       internal_mesh_{internal_mesh}
   {
     PCMS_FUNCTION_TIMER;
   }
   // FIXME should take a file path for the parameters, not take adios2 params.
   // These fields are supposed to be agnostic to adios2...
+  /**
+   * @param layout_name fields that are defined on the same vertices (same
+   * adapter geometry and overlap mask) can provide a shared layout name. Only
+   * the first field with a given layout name exchanges the GIDs with the
+   * client, all others reuse its layout. The client must add its fields with
+   * the same layout names.
+   */
   template <typename FieldAdapterT>
   ConvertibleCoupledField* AddField(
     std::string name, FieldAdapterT&& field_adapter,
@@ -223,7 +299,8 @@ public:
     FieldEvaluationMethod to_field_eval_method,
     FieldTransferMethod from_field_transfer_method,
     FieldEvaluationMethod from_field_eval_method,
-    Omega_h::Read<Omega_h::I8> internal_field_mask = {})
+    Omega_h::Read<Omega_h::I8> internal_field_mask = {},
+    std::string layout_name = "")
   {
     PCMS_FUNCTION_TIMER;
     auto [it, inserted] = fields_.template try_emplace(
@@ -231,7 +308,7 @@ public:
       channel_, internal_mesh_,
       TransferOptions{to_field_transfer_method, to_field_eval_method},
       TransferOptions{from_field_transfer_method, from_field_eval_method},
-      internal_field_mask);
+      internal_field_mask, &layout_cache_, std::move(layout_name));
     if (!inserted) {
       std::cerr << "OHField with this name" << name << "already exists!\n";
       std::terminate();
@@ -250,6 +327,57 @@ public:
     PCMS_ALWAYS_ASSERT(InReceivePhase());
     detail::find_or_error(name, fields_).Receive(mode);
   };
+  /**
+   * Post a receive for a field without deserializing it. This allows receives
+   * from several fields (or applications) to be in flight together. When
+   * posted with Mode::Deferred, call Complete on the returned handle after
+   * EndReceivePhase.
+   */
+  [[nodiscard]] PendingReceive PostReceiveField(const std::string& name,
+                                                Mode mode = Mode::Deferred)
+  {
+    PCMS_FUNCTION_TIMER;
+    PCMS_ALWAYS_ASSERT(InReceivePhase());
+    return detail::find_or_error(name, fields_).PostReceive(mode);
+  }
+  /**
+   * Send a group of fields as a single message. The fields must have the same
+   * value type and share a layout (see AddField). The client must send or
+   * receive the group with the same field names in the same order.
+   */
+  void SendFields(const std::vector<std::string>& names,
+                  Mode mode = Mode::Synchronous)
+  {
+    PCMS_FUNCTION_TIMER;
+    PCMS_ALWAYS_ASSERT(InSendPhase());
+    GetFieldGroup(names).Send(mode);
+  }
+  /// Receive a group of fields that was sent as a single message
+  void ReceiveFields(const std::vector<std::string>& names,
+                     Mode mode = Mode::Synchronous)
+  {
+    PCMS_FUNCTION_TIMER;
+    PCMS_ALWAYS_ASSERT(InReceivePhase());
+    GetFieldGroup(names).Receive(mode);
+  }
+  /// Post a receive for a group of fields, see PostReceiveField
+  [[nodiscard]] PendingReceive PostReceiveFields(
+    const std::vector<std::string>& names, Mode mode = Mode::Deferred)
+  {
+    PCMS_FUNCTION_TIMER;
+    PCMS_ALWAYS_ASSERT(InReceivePhase());
+    return GetFieldGroup(names).PostReceive(mode);
+  }
+  /// true if the field was added to this application
+  [[nodiscard]] bool OwnsField(
+    const ConvertibleCoupledField& field) const noexcept
+  {
+    PCMS_FUNCTION_TIMER;
+    return std::any_of(fields_.begin(), fields_.end(),
+                       [&field](const auto& entry) {
+                         return &entry.second == &field;
+                       });
+  }
   [[nodiscard]] bool InSendPhase() const noexcept
   {
     PCMS_FUNCTION_TIMER;
@@ -295,13 +423,36 @@ public:
   }
 
 private:
+  FieldGroupCommunicator& GetFieldGroup(const std::vector<std::string>& names)
+  {
+    PCMS_FUNCTION_TIMER;
+    PCMS_ALWAYS_ASSERT(!names.empty());
+    auto group_name = detail::FieldGroupName(names);
+    auto it = field_groups_.find(group_name);
+    if (it == field_groups_.end()) {
+      std::vector<ConvertibleCoupledField*> fields;
+      fields.reserve(names.size());
+      for (const auto& name : names) {
+        fields.push_back(&detail::find_or_error(name, fields_));
+      }
+      auto group =
+        fields.front()->CreateFieldGroup(group_name, channel_, fields);
+      it = field_groups_.emplace(std::move(group_name), std::move(group)).first;
+    }
+    return it->second;
+  }
+
   MPI_Comm mpi_comm_;
   redev::Redev& redev_;
   redev::Channel channel_;
+  // layouts must outlive the fields that refer to them
+  FieldLayoutCache layout_cache_;
   // map is used rather than unordered_map because we give pointers to the
   // internal data and rehash of unordered_map can cause pointer invalidation.
   // map is less cache friendly, but pointers are not invalidated.
   std::map<std::string, ConvertibleCoupledField> fields_;
+  // field groups hold pointers to the fields, so they are declared after them
+  std::map<std::string, FieldGroupCommunicator> field_groups_;
   Omega_h::Mesh& internal_mesh_;
 };
 class GatherOperation
@@ -331,21 +482,219 @@ public:
     }
     combiner_(internal_fields_, combined_field_);
   };
+  /**
+   * Pipelined gather, first part. Posts deferred receives for all fields.
+   * Must be called while every application that owns one of the gathered
+   * fields is in its receive phase.
+   */
+  void BeginRun()
+  {
+    PCMS_FUNCTION_TIMER;
+    PCMS_ALWAYS_ASSERT(pending_receives_.empty());
+    pending_receives_.reserve(coupled_fields_.size());
+    for (auto& field : coupled_fields_) {
+      pending_receives_.push_back(field.get().PostReceive(Mode::Deferred));
+    }
+  }
+  /**
+   * Pipelined gather, second part. Call right after the receive phase of the
+   * application has ended, while the receive phases of the other
+   * applications are still open. Deserializes the gathered fields of the
+   * application and launches their native to internal transfer without
+   * fencing. Ending the next application's receive phase performs its
+   * deferred data transfer, which then overlaps these kernels when they run
+   * on a device.
+   */
+  void ProgressRun(const Application& application)
+  {
+    PCMS_FUNCTION_TIMER;
+    PCMS_ALWAYS_ASSERT(pending_receives_.size() == coupled_fields_.size());
+    PCMS_ALWAYS_ASSERT(!application.InReceivePhase());
+    for (size_t i = 0; i < coupled_fields_.size(); ++i) {
+      if (!pending_receives_[i].IsComplete() &&
+          application.OwnsField(coupled_fields_[i].get())) {
+        CompleteField(i);
+      }
+    }
+  }
+  /**
+   * Pipelined gather, last part. Must be called after all receive phases have
+   * ended. Completes the fields that were not handled by ProgressRun and
+   * runs the combiner once all internal fields are ready.
+   */
+  void EndRun()
+  {
+    PCMS_FUNCTION_TIMER;
+    PCMS_ALWAYS_ASSERT(pending_receives_.size() == coupled_fields_.size());
+    for (size_t i = 0; i < coupled_fields_.size(); ++i) {
+      if (!pending_receives_[i].IsComplete()) {
+        CompleteField(i);
+      }
+    }
+    pending_receives_.clear();
+    Kokkos::fence();
+    combiner_(internal_fields_, combined_field_);
+  }
 
 private:
+  void CompleteField(size_t i)
+  {
+    PCMS_FUNCTION_TIMER;
+    pending_receives_[i].Complete();
+    coupled_fields_[i].get().SyncNativeToInternal();
+  }
+
   std::vector<std::reference_wrapper<ConvertibleCoupledField>> coupled_fields_;
   std::vector<std::reference_wrapper<InternalField>> internal_fields_;
   InternalField& combined_field_;
   CombinerFunction combiner_;
+  std::vector<PendingReceive> pending_receives_;
+};
+struct ScatterOptions
+{
+  /// mode used to send each field. With Mode::Deferred the send of a field is
+  /// posted as soon as its data is ready and completes at the end of the send
+  /// phase, so later fields are interpolated while earlier messages are in
+  /// flight
+  Mode send_mode = Mode::Synchronous;
+  /// fields with the same value type that are defined on the same vertices
+  /// get identical data from the combined field. When true, the combined
+  /// field is copied/interpolated once per such batch and the result is
+  /// copied into the other fields of the batch
+  bool batch_interpolation = false;
 };
+namespace detail
+{
+using ScatterBatch = std::vector<size_t>;
+/**
+ * true if both internal fields have the same value type and are defined on the
+ * same vertices
+ */
+inline bool IsSameVertexSet(const InternalField& a, const InternalField& b)
+{
+  PCMS_FUNCTION_TIMER;
+  return std::visit(
+    [](const auto& fa, const auto& fb) {
+      if constexpr (std::is_same_v<decltype(fa), decltype(fb)>) {
+        return HasSameVertices(fa, fb);
+      } else {
+        return false;
+      }
+    },
+    a, b);
+}
+/**
+ * true if every field in the batch is on the same vertex set as the first
+ * field of the batch, so the data of the first field can be copied into the
+ * others
+ */
+inline bool IsValidScatterBatch(
+  const std::vector<std::reference_wrapper<InternalField>>& fields,
+  const ScatterBatch& batch)
+{
+  PCMS_FUNCTION_TIMER;
+  if (batch.empty()) {
+    return false;
+  }
+  const auto& first = fields[batch.front()].get();
+  return std::all_of(batch.begin(), batch.end(), [&](size_t i) {
+    return i < fields.size() && IsSameVertexSet(first, fields[i].get());
+  });
+}
+/**
+ * Groups the field indices whose data is computed once from the combined
+ * field. Without batch_interpolation every field is its own batch.
+ */
+inline std::vector<ScatterBatch> ConstructScatterBatches(
+  const std::vector<std::reference_wrapper<InternalField>>& fields,
+  bool batch_interpolation)
+{
+  PCMS_FUNCTION_TIMER;
+  std::vector<ScatterBatch> batches;
+  for (size_t i = 0; i < fields.size(); ++i) {
+    auto& field = fields[i].get();
+    auto batch = std::find_if(
+      batches.begin(), batches.end(), [&](const ScatterBatch& b) {
+        return batch_interpolation &&
+               IsSameVertexSet(fields[b.front()].get(), field);
+      });
+    if (batch == batches.end()) {
+      batches.push_back({i});
+    } else {
+      batch->push_back(i);
+    }
+  }
+  return batches;
+}
+inline void TransferFromCombined(const InternalField& combined,
+                                 InternalField& target)
+{
+  PCMS_FUNCTION_TIMER;
+  std::visit(
+    [](const auto& combined_field, auto& internal_field) {
+      constexpr bool can_copy = std::is_same_v<
+        typename std::remove_reference_t<
+          std::remove_cv_t<decltype(combined_field)>>::value_type,
+        typename std::remove_reference_t<
+          std::remove_cv_t<decltype(internal_field)>>::value_type>;
+      if constexpr (can_copy) {
+        copy_field(combined_field, internal_field);
+      } else {
+        interpolate_field(combined_field, internal_field);
+      }
+    },
+    combined, target);
+}
+inline void CopyInternalField(const InternalField& source,
+                              InternalField& target)
+{
+  PCMS_FUNCTION_TIMER;
+  std::visit(
+    [](const auto& source_field, auto& target_field) {
+      if constexpr (std::is_same_v<
+                      std::remove_cv_t<
+                        std::remove_reference_t<decltype(source_field)>>,
+                      std::remove_reference_t<decltype(target_field)>>) {
+        copy_field(source_field, target_field);
+      } else {
+        std::cerr << "fields in a scatter batch must have the same type\n";
+        std::abort();
+      }
+    },
+    source, target);
+}
+/**
+ * Transfers the combined field into the first field of the batch and copies
+ * the result into the remaining fields. Aborts if the batch contains fields
+ * on different vertex sets.
+ */
+inline void ScatterToBatch(
+  const InternalField& combined,
+  const std::vector<std::reference_wrapper<InternalField>>& fields,
+  const ScatterBatch& batch)
+{
+  PCMS_FUNCTION_TIMER;
+  if (!IsValidScatterBatch(fields, batch)) {
+    std::cerr << "fields in a scatter batch must be defined on the same "
+                 "vertices\n";
+    std::abort();
+  }
+  auto& first = fields[batch.front()].get();
+  TransferFromCombined(combined, first);
+  for (size_t i = 1; i < batch.size(); ++i) {
+    CopyInternalField(first, fields[batch[i]].get());
+  }
+}
+} // namespace detail
 class ScatterOperation
 {
 public:
   ScatterOperation(std::vector<std::reference_wrapper<ConvertibleCoupledField>>
                      fields_to_scatter,
-                   InternalField& combined_field)
+                   InternalField& combined_field, ScatterOptions options = {})
     : coupled_fields_(std::move(fields_to_scatter)),
-      combined_field_{combined_field}
+      combined_field_{combined_field},
+      options_(options)
   {
     PCMS_FUNCTION_TIMER;
 
@@ -355,7 +704,11 @@ public:
                    [](ConvertibleCoupledField& fld) {
                      return std::ref(fld.GetInternalField());
                    });
+    batches_ = detail::ConstructScatterBatches(internal_fields_,
+                                               options_.batch_interpolation);
   }
+  // Run must be called during the send phase of the applications that own the
+  // scattered fields
   void Run() const
   {
     PCMS_FUNCTION_TIMER;
@@ -363,29 +716,13 @@ public:
     // needed splitter(combined_field, internal_fields_);
     // for current use case, we copy the combined field
     // into application internal fields
-    std::visit(
-      [this](const auto& combined_field) {
-        for (auto& field : coupled_fields_) {
-          std::visit(
-            [&](auto& internal_field) {
-              constexpr bool can_copy = std::is_same_v<
-                typename std::remove_reference_t<
-                  std::remove_cv_t<decltype(combined_field)>>::value_type,
-                typename std::remove_reference_t<
-                  std::remove_cv_t<decltype(internal_field)>>::value_type>;
-              if constexpr (can_copy) {
-                copy_field(combined_field, internal_field);
-              } else {
-                interpolate_field(combined_field, internal_field);
-              }
-            },
-            field.get().GetInternalField());
-        }
-      },
-      combined_field_);
-    for (auto& field : coupled_fields_) {
-      field.get().SyncInternalToNative();
-      field.get().Send(Mode::Synchronous);
+    for (const auto& batch : batches_) {
+      detail::ScatterToBatch(combined_field_, internal_fields_, batch);
+      for (auto i : batch) {
+        auto& field = coupled_fields_[i].get();
+        field.SyncInternalToNative();
+        field.Send(options_.send_mode);
+      }
     }
   };
 
@@ -393,6 +730,8 @@ private:
   std::vector<std::reference_wrapper<ConvertibleCoupledField>> coupled_fields_;
   std::vector<std::reference_wrapper<InternalField>> internal_fields_;
   InternalField& combined_field_;
+  ScatterOptions options_;
+  std::vector<detail::ScatterBatch> batches_;
 };
 
 class CouplerServer
@@ -436,6 +775,30 @@ public:
     PCMS_FUNCTION_TIMER;
     detail::find_or_error(name, gather_operations_).Run();
   }
+  /**
+   * Start a pipelined gather. Call while the applications that own the
+   * gathered fields are in their receive phase. End the receive phases one
+   * application at a time and call ProgressGatherFields after each, then call
+   * EndGatherFields once all receive phases have ended. The fields of an
+   * application are converted while the data of the next one is transferred.
+   */
+  void BeginGatherFields(const std::string& name)
+  {
+    PCMS_FUNCTION_TIMER;
+    detail::find_or_error(name, gather_operations_).BeginRun();
+  }
+  /// convert the gathered fields of an application whose receive phase ended
+  void ProgressGatherFields(const std::string& name,
+                            const Application& application)
+  {
+    PCMS_FUNCTION_TIMER;
+    detail::find_or_error(name, gather_operations_).ProgressRun(application);
+  }
+  void EndGatherFields(const std::string& name)
+  {
+    PCMS_FUNCTION_TIMER;
+    detail::find_or_error(name, gather_operations_).EndRun();
+  }
   template <typename CombinedFieldT = Real>
   [[nodiscard]] GatherOperation* AddGatherFieldsOp(
     const std::string& name,
@@ -444,14 +807,14 @@ public:
     Omega_h::Read<Omega_h::I8> mask = {}, std::string global_id_name = "")
   {
     PCMS_FUNCTION_TIMER;
-    static constexpr int search_nx = 10;
-    static constexpr int search_ny = 10;
-
     auto& combined = detail::find_or_create_internal_field<CombinedFieldT>(
       internal_field_name, internal_fields_, internal_mesh_, mask,
       std::move(global_id_name));
     std::visit([&](auto& field) {
-      field.ConstructSearch(search_nx, search_ny);
+      // gather and scatter ops may share the combined field
+      if (!field.HasSearch()) {
+        field.ConstructSearch();
+      }
     },combined);
     auto [it, inserted] = gather_operations_.template try_emplace(
       name, std::move(gather_fields), combined, std::move(func));
@@ -480,20 +843,21 @@ public:
   [[nodiscard]] ScatterOperation* AddScatterFieldsOp(
     const std::string& name, const std::string& internal_field_name,
     std::vector<std::reference_wrapper<ConvertibleCoupledField>> scatter_fields,
-    Omega_h::Read<Omega_h::I8> mask = {}, std::string global_id_name = "")
+    Omega_h::Read<Omega_h::I8> mask = {}, std::string global_id_name = "",
+    ScatterOptions options = {})
   {
     PCMS_FUNCTION_TIMER;
-    static constexpr int search_nx = 10;
-    static constexpr int search_ny = 10;
-
     auto& combined = detail::find_or_create_internal_field<CombinedFieldT>(
       internal_field_name, internal_fields_, internal_mesh_, mask,
       std::move(global_id_name));
     std::visit([&](auto& field) {
-      field.ConstructSearch(search_nx, search_ny);
+      // gather and scatter ops may share the combined field
+      if (!field.HasSearch()) {
+        field.ConstructSearch();
+      }
     },combined);
     auto [it, inserted] = scatter_operations_.template try_emplace(
-      name, std::move(scatter_fields), combined);
+      name, std::move(scatter_fields), combined, options);
 
     if (!inserted) {
       std::cerr << "Scatter with this name" << name << "already exists!\n";
@@ -1,5 +1,6 @@
 #ifndef PCMS_COUPLING_TRANSFER_FIELD_H
 #define PCMS_COUPLING_TRANSFER_FIELD_H
+#include <type_traits>
 #include <utility>
 #include "pcms/arrays.h"
 #include "pcms/field_evaluation_methods.h"
@@ -76,6 +77,40 @@ void interpolate_field(const SourceField& source_field,
     set_nodal_data(target_field, make_array_view(data));
   }
 }
+/**
+ * Transfer that preserves the integral of the field. Only implemented for
+ * specific field types (see omega_h_field.h), other fields abort.
+ */
+template <typename SourceField, typename TargetField>
+void conservative_transfer(const SourceField& /* source_field */,
+                           TargetField& /* target_field */)
+{
+  PCMS_FUNCTION_TIMER;
+  std::cerr << "Conservative transfer is not implemented for these fields!\n";
+  std::abort();
+}
+
+namespace detail
+{
+// true if the source field can be evaluated with the method at the
+// coordinates of the target field
+template <typename SourceField, typename TargetField, typename Method,
+          typename = void>
+struct CanEvaluate : std::false_type
+{
+};
+template <typename SourceField, typename TargetField, typename Method>
+struct CanEvaluate<
+  SourceField, TargetField, Method,
+  std::void_t<decltype(evaluate(
+    std::declval<const SourceField&>(), std::declval<Method>(),
+    make_const_array_view(
+      std::declval<decltype(get_nodal_coordinates(
+        std::declval<const TargetField&>()))&>())))>> : std::true_type
+{
+};
+} // namespace detail
+
 template <typename SourceField, typename TargetField>
 void transfer_field(const SourceField& source, TargetField& target,
                     FieldTransferMethod transfer_method,
@@ -93,6 +128,9 @@ void transfer_field(const SourceField& source, TargetField& target,
         std::abort();
       }
       return;
+    case FieldTransferMethod::Conservative:
+      conservative_transfer(source, target);
+      return;
     case FieldTransferMethod::Interpolate:
       switch (evaluation_method) {
         case FieldEvaluationMethod::None:
@@ -104,6 +142,26 @@ void transfer_field(const SourceField& source, TargetField& target,
         case FieldEvaluationMethod::NearestNeighbor:
           interpolate_field(source, target, NearestNeighbor{});
           break;
+        case FieldEvaluationMethod::Lagrange2:
+          if constexpr (detail::CanEvaluate<SourceField, TargetField,
+                                            Lagrange<2>>::value) {
+            interpolate_field(source, target, Lagrange<2>{});
+          } else {
+            std::cerr << "Lagrange2 evaluation is not implemented for the "
+                         "source field!\n";
+            std::abort();
+          }
+          break;
+        case FieldEvaluationMethod::MovingLeastSquares:
+          if constexpr (detail::CanEvaluate<SourceField, TargetField,
+                                            MovingLeastSquares>::value) {
+            interpolate_field(source, target, MovingLeastSquares{});
+          } else {
+            std::cerr << "MovingLeastSquares evaluation is not implemented "
+                         "for the source field!\n";
+            std::abort();
+          }
+          break;
           // no default case for compiler error on missing cases
       }
       return;
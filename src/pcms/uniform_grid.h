@@ -24,6 +24,14 @@ public:
   //template <typename T>
   //[[nodiscard]] KOKKOS_INLINE_FUNCTION LO ClosestCellID(const T& point) const
   [[nodiscard]] KOKKOS_INLINE_FUNCTION LO ClosestCellID(const Omega_h::Vector<2>& point) const
+  {
+    auto [i, j] = ClosestTwoDCellIndex(point);
+    return GetCellIndex(i, j);
+  }
+  /// return the (row, column) index of the grid cell that the input point is
+  /// inside or closest to if the point lies outside
+  [[nodiscard]] KOKKOS_INLINE_FUNCTION std::array<LO, 2> ClosestTwoDCellIndex(
+    const Omega_h::Vector<2>& point) const
   {
     std::array<Real, dim> distance_within_grid{point[0] - bot_left[0],
                                                point[1] - bot_left[1]};
@@ -40,7 +48,7 @@ public:
           static_cast<LO>(std::floor(distance_within_grid[i] * divisions[i]/edge_length[i]));
       }
     }
-    return GetCellIndex(indexes[0], indexes[1]);
+    return indexes;
   }
   [[nodiscard]] KOKKOS_INLINE_FUNCTION AABBox<dim> GetCellBBOX(LO idx) const
   {
@@ -9,6 +9,13 @@
 #include "pcms/assert.h"
 #include "pcms/array_mask.h"
 #include "pcms/profile.h"
+#include "pcms/field_evaluation_methods.h"
+#include "pcms/mls_interpolation.h"
+#include <algorithm>
+#include <memory>
+#include <typeindex>
+#include <utility>
+#include <mpi.h>
 
 namespace pcms
 {
@@ -34,13 +41,141 @@ struct GetRank
   }
   const GeomType& geom_;
 };
+
+/**
+ * Buffer in a shared memory window with one copy per node. The first rank of
+ * each node (in plane rank order) allocates the window and joins the leader
+ * communicator, which holds one rank per node. All constructor and member
+ * calls are collective on the plane communicator.
+ */
+template <typename T>
+class NodeSharedBuffer
+{
+public:
+  NodeSharedBuffer(MPI_Comm plane_comm, LO size) : size_(size)
+  {
+    PCMS_FUNCTION_TIMER;
+    int plane_rank;
+    MPI_Comm_rank(plane_comm, &plane_rank);
+    MPI_Comm_split_type(plane_comm, MPI_COMM_TYPE_SHARED, plane_rank,
+                        MPI_INFO_NULL, &node_comm_);
+    int node_rank;
+    MPI_Comm_rank(node_comm_, &node_rank);
+    MPI_Comm_split(plane_comm, (node_rank == 0) ? 0 : MPI_UNDEFINED,
+                   plane_rank, &leader_comm_);
+    const MPI_Aint bytes = (node_rank == 0) ? size * sizeof(T) : 0;
+    MPI_Win_allocate_shared(bytes, sizeof(T), MPI_INFO_NULL, node_comm_,
+                            &data_, &window_);
+    if (node_rank != 0) {
+      MPI_Aint leader_bytes;
+      int displacement_unit;
+      MPI_Win_shared_query(window_, 0, &leader_bytes, &displacement_unit,
+                           &data_);
+    }
+  }
+  NodeSharedBuffer(const NodeSharedBuffer&) = delete;
+  NodeSharedBuffer& operator=(const NodeSharedBuffer&) = delete;
+  ~NodeSharedBuffer()
+  {
+    MPI_Win_free(&window_);
+    if (leader_comm_ != MPI_COMM_NULL) {
+      MPI_Comm_free(&leader_comm_);
+    }
+    MPI_Comm_free(&node_comm_);
+  }
+  [[nodiscard]] T* data() const noexcept { return data_; }
+  [[nodiscard]] LO size() const noexcept { return size_; }
+  /// wait until all ranks of the node finished reading the buffer so it can
+  /// be overwritten
+  void Fence() const { MPI_Win_fence(0, window_); }
+  /// copy the buffer of the plane root's node to all other nodes
+  void Broadcast() const
+  {
+    PCMS_FUNCTION_TIMER;
+    if (leader_comm_ != MPI_COMM_NULL) {
+      MPI_Bcast(data_, size_, redev::getMpiType(T{}), 0, leader_comm_);
+    }
+    Fence();
+  }
+
+private:
+  LO size_;
+  T* data_ = nullptr;
+  MPI_Comm node_comm_ = MPI_COMM_NULL;
+  MPI_Comm leader_comm_ = MPI_COMM_NULL;
+  MPI_Win window_ = MPI_WIN_NULL;
+};
+
+// identifies the target coordinates of a cached moving least squares operator
+struct MLSOperatorKey
+{
+  const void* coordinates;
+  size_t size;
+  std::type_index memory_space;
+  int method_parameter;
+  bool operator==(const MLSOperatorKey& other) const noexcept
+  {
+    return coordinates == other.coordinates && size == other.size &&
+           memory_space == other.memory_space &&
+           method_parameter == other.method_parameter;
+  }
+};
+template <typename MemorySpace>
+struct CachedMLSOperator
+{
+  // copy of the target coordinates the operator was built for
+  Kokkos::View<Real*, MemorySpace> coordinates;
+  InterpolationOperator<MemorySpace> op;
+};
+// true if the cached coordinates hold the same values as the coordinates
+template <typename MemorySpace>
+bool SameCoordinates(const Kokkos::View<Real*, MemorySpace>& cached,
+                     ScalarArrayView<const Real, MemorySpace> coordinates)
+{
+  PCMS_FUNCTION_TIMER;
+  if (cached.size() != coordinates.size()) {
+    return false;
+  }
+  const Real* values = coordinates.data_handle();
+  LO mismatches = 0;
+  Kokkos::parallel_reduce(
+    Kokkos::RangePolicy<typename MemorySpace::execution_space>(0,
+                                                               cached.size()),
+    KOKKOS_LAMBDA(LO i, LO & local_mismatches) {
+      local_mismatches += (cached(i) != values[i]);
+    },
+    mismatches);
+  return mismatches == 0;
+}
 } // namespace detail
 
-template <typename T, typename CoordinateElementType = Real>
+/// how XGCFieldAdapter::Deserialize distributes the data received on the
+/// plane root to the other ranks of the plane
+enum class XGCPlaneDistribution
+{
+  /// broadcast the full data array over the plane communicator
+  Broadcast,
+  /// broadcast only the overlap entries. Every rank applies the overlap mask
+  /// to its own copy of the data.
+  Overlap,
+  /// broadcast the overlap entries to one rank per node into a shared memory
+  /// window (MPI_Win_allocate_shared). The other ranks of the node read that
+  /// copy, so the inter node traffic does not grow with the ranks per node.
+  SharedMemory
+};
+
+/**
+ * Field adapter for XGC data. The data (and coordinates) may live in any
+ * memory space. For device memory spaces, the mask is applied on the device
+ * and only the overlap entries are staged through host memory to the
+ * communication buffers.
+ */
+template <typename T, typename CoordinateElementType = Real,
+          typename MemorySpace = HostMemorySpace>
 class XGCFieldAdapter
 {
 public:
-  using memory_space = HostMemorySpace;
+  using memory_space = MemorySpace;
   using value_type = T;
   using coordinate_element_type = CoordinateElementType;
   /**
@@ -69,54 +204,132 @@ public:
     // PCMS_ALWAYS_ASSERT(reverse_classification.nverts() == data.size());
     MPI_Comm_rank(plane_comm_, &plane_rank_);
     if (RankParticipatesCouplingCommunication()) {
-      Kokkos::View<int8_t*, HostMemorySpace> mask("mask", data.size());
-      PCMS_ALWAYS_ASSERT((bool)in_overlap);
-      for (auto& geom : reverse_classification_) {
-        if (in_overlap(geom.first.dim, geom.first.id)) {
-          for (auto vert : geom.second) {
-            PCMS_ALWAYS_ASSERT(vert < data.size());
-            mask(vert) = 1;
-          }
-        }
-      }
-      mask_ = ArrayMask<memory_space>{make_const_array_view(mask)};
-      PCMS_ALWAYS_ASSERT(!mask_.empty());
+      BuildMask();
       //// XGC meshes are naively ordered in iteration order (full mesh on every
       //// cpu) First ID in XGC is 1!
       std::iota(gids_.begin(), gids_.end(), static_cast<GO>(1));
     }
   }
+  /**
+   * Field with the coordinates of its vertices, which is needed to
+   * interpolate to or from the field. The coordinates are interleaved
+   * (r0, z0, r1, z1, ...). Coordinates in the adapter's memory space are used
+   * in place and must outlive the adapter like the data. Coordinates in other
+   * memory spaces are copied.
+   */
+  template <typename CoordinateMemorySpace>
+  XGCFieldAdapter(
+    std::string name, MPI_Comm plane_communicator,
+    ScalarArrayView<T, memory_space> data,
+    const ReverseClassificationVertex& reverse_classification,
+    std::function<int8_t(int, int)> in_overlap,
+    ScalarArrayView<const CoordinateElementType, CoordinateMemorySpace>
+      coordinates)
+    : XGCFieldAdapter(std::move(name), plane_communicator, data,
+                      reverse_classification, std::move(in_overlap))
+  {
+    PCMS_FUNCTION_TIMER;
+    PCMS_ALWAYS_ASSERT(coordinates.size() == 2 * data.size());
+    coordinates_ = Kokkos::create_mirror_view_and_copy(
+      memory_space{},
+      Kokkos::View<const CoordinateElementType*, CoordinateMemorySpace,
+                   Kokkos::MemoryTraits<Kokkos::Unmanaged>>(
+        coordinates.data_handle(), coordinates.size()));
+  }
 
+  /**
+   * Pack the overlap entries into the host buffer. For device data, the mask
+   * is applied on the device and only the overlap entries are copied to the
+   * host.
+   */
   int Serialize(
-    ScalarArrayView<T, memory_space> buffer,
-    ScalarArrayView<const pcms::LO, memory_space> permutation) const
+    ScalarArrayView<T, HostMemorySpace> buffer,
+    ScalarArrayView<const pcms::LO, HostMemorySpace> permutation) const
   {
     PCMS_FUNCTION_TIMER;
-    static_assert(std::is_same_v<memory_space, pcms::HostMemorySpace>,
-                  "gpu space unhandled\n");
     if (RankParticipatesCouplingCommunication()) {
-      auto const_data = ScalarArrayView<const T, memory_space>{
-        data_.data_handle(), data_.size()};
       if (buffer.size() > 0) {
-        mask_.Apply(const_data, buffer, permutation);
+        auto const_data = ScalarArrayView<const T, memory_space>{
+          data_.data_handle(), data_.size()};
+        if constexpr (std::is_same_v<memory_space, HostMemorySpace>) {
+          mask_.Apply(const_data, buffer, permutation);
+        } else {
+          mask_.Apply(const_data, make_array_view(staging_));
+          Kokkos::deep_copy(staging_h_, staging_);
+          for (LO i = 0; i < mask_.Size(); ++i) {
+            buffer[permutation.empty() ? i : permutation[i]] = staging_h_(i);
+          }
+        }
       }
       return mask_.Size();
     }
     return 0;
   }
+  /**
+   * Unpack the host buffer into the overlap entries and distribute the data
+   * to the other ranks of the plane (see XGCPlaneDistribution). For device
+   * data, only the overlap entries are copied to the device. With the
+   * Broadcast distribution, the full data is sent directly from the device if
+   * MPI is GPU aware (see mpi_accessible_v).
+   */
   void Deserialize(
-    ScalarArrayView<const T, memory_space> buffer,
-    ScalarArrayView<const pcms::LO, memory_space> permutation) const
+    ScalarArrayView<const T, HostMemorySpace> buffer,
+    ScalarArrayView<const pcms::LO, HostMemorySpace> permutation) const
   {
     PCMS_FUNCTION_TIMER;
-    static_assert(std::is_same_v<memory_space, pcms::HostMemorySpace>,
-                  "gpu space unhandled\n");
-    if (RankParticipatesCouplingCommunication()) {
-      mask_.ToFullArray(buffer, data_, permutation);
+    switch (plane_distribution_) {
+      case XGCPlaneDistribution::Broadcast:
+        if (RankParticipatesCouplingCommunication()) {
+          if constexpr (std::is_same_v<memory_space, HostMemorySpace>) {
+            mask_.ToFullArray(buffer, data_, permutation);
+          } else {
+            PackOverlap(buffer, permutation, staging_h_.data());
+            Kokkos::deep_copy(staging_, staging_h_);
+            mask_.ToFullArray(make_const_array_view(staging_), data_);
+          }
+        }
+        BroadcastData();
+        return;
+      case XGCPlaneDistribution::Overlap:
+        if (RankParticipatesCouplingCommunication()) {
+          PackOverlap(buffer, permutation, staging_h_.data());
+        }
+        MPI_Bcast(staging_h_.data(), staging_h_.size(),
+                  redev::getMpiType(value_type{}), plane_root_, plane_comm_);
+        UnpackOverlap(staging_h_.data());
+        return;
+      case XGCPlaneDistribution::SharedMemory:
+        shared_buffer_->Fence();
+        if (RankParticipatesCouplingCommunication()) {
+          PackOverlap(buffer, permutation, shared_buffer_->data());
+        }
+        shared_buffer_->Broadcast();
+        UnpackOverlap(shared_buffer_->data());
+        return;
+        // no default case for compiler error on missing distribution
+    }
+  }
+  /**
+   * Select how Deserialize distributes the data over the plane. Must be
+   * called on all ranks of the plane communicator. Setting the SharedMemory
+   * distribution allocates the shared memory window.
+   */
+  void SetPlaneDistribution(XGCPlaneDistribution distribution)
+  {
+    PCMS_FUNCTION_TIMER;
+    if (distribution != XGCPlaneDistribution::Broadcast && mask_.empty()) {
+      BuildMask();
+    }
+    if (distribution == XGCPlaneDistribution::SharedMemory &&
+        shared_buffer_ == nullptr) {
+      shared_buffer_ = std::make_shared<detail::NodeSharedBuffer<T>>(
+        plane_comm_, mask_.Size());
     }
-    // duplicate the data on the root rank of the plane to all other ranks
-    MPI_Bcast(data_.data_handle(), data_.size(),
-              redev::getMpiType(value_type{}), plane_root_, plane_comm_);
+    plane_distribution_ = distribution;
+  }
+  [[nodiscard]] XGCPlaneDistribution GetPlaneDistribution() const noexcept
+  {
+    return plane_distribution_;
   }
 
   // REQUIRED
@@ -125,9 +338,12 @@ public:
     PCMS_FUNCTION_TIMER;
     if (RankParticipatesCouplingCommunication()) {
       std::vector<GO> gids(mask_.Size());
-      auto v1 = make_array_view(gids_);
-      auto v2 = make_array_view(gids);
-      mask_.Apply(v1, v2);
+      const auto map = HostMaskMap();
+      for (size_t i = 0; i < map.size(); ++i) {
+        if (map(i) > 0) {
+          gids[map(i) - 1] = gids_[i];
+        }
+      }
       return gids;
     }
     return {};
@@ -143,17 +359,17 @@ public:
       pcms::ReversePartitionMap reverse_partition;
       // in_overlap_ must contain a function!
       PCMS_ALWAYS_ASSERT(static_cast<bool>(in_overlap_));
+      // the map gives the local iteration order of the global ids
+      const auto map = HostMaskMap();
       for (const auto& geom : reverse_classification_) {
         // if the geometry is in specified overlap region
         if (in_overlap_(geom.first.dim, geom.first.id)) {
 
           auto dr = std::visit(detail::GetRank{geom.first}, partition);
           auto [it, inserted] = reverse_partition.try_emplace(dr);
-          // the map gives the local iteration order of the global ids
-          auto map = mask_.GetMap();
           std::transform(geom.second.begin(), geom.second.end(),
                          std::back_inserter(it->second), [&map](auto v) {
-                           auto idx = map[v];
+                           auto idx = map(v);
                            PCMS_ALWAYS_ASSERT(idx > 0);
                            return idx - 1;
                          });
@@ -177,8 +393,153 @@ public:
     // only do adios communications on 0 rank of the XGC fields
     return (plane_rank_ == plane_root_);
   }
+  // NOT REQUIRED PART OF FieldAdapter interface
+  [[nodiscard]] ScalarArrayView<T, memory_space> GetData() const noexcept
+  {
+    return data_;
+  }
+  // NOT REQUIRED PART OF FieldAdapter interface
+  [[nodiscard]] const Kokkos::View<const CoordinateElementType*, memory_space>&
+  GetCoordinates() const noexcept
+  {
+    return coordinates_;
+  }
+  [[nodiscard]] bool HasCoordinates() const noexcept
+  {
+    return coordinates_.size() > 0;
+  }
+  /**
+   * Moving least squares operator from the vertices of the plane to the
+   * coordinates. The operator is built on the first evaluation at the
+   * coordinates and cached by their address and size and by the number of
+   * neighbors, so later evaluations only apply the sparse operator to the
+   * current data. A cached operator is only reused if the coordinates still
+   * hold the values it was built for. At most max_cached_operators operators
+   * are kept and the oldest is dropped first.
+   */
+  template <typename TargetMemorySpace>
+  [[nodiscard]] const InterpolationOperator<TargetMemorySpace>& GetMLSOperator(
+    MovingLeastSquares method,
+    ScalarArrayView<const Real, TargetMemorySpace> coordinates) const
+  {
+    PCMS_FUNCTION_TIMER;
+    using Cached = detail::CachedMLSOperator<TargetMemorySpace>;
+    const detail::MLSOperatorKey key{
+      coordinates.data_handle(), coordinates.size(),
+      std::type_index(typeid(TargetMemorySpace)),
+      detail::method_parameter(method)};
+    auto it = std::find_if(
+      mls_operators_.begin(), mls_operators_.end(),
+      [&key](const auto& entry) { return entry.first == key; });
+    if (it != mls_operators_.end()) {
+      const auto& cached = *std::static_pointer_cast<const Cached>(it->second);
+      if (detail::SameCoordinates(cached.coordinates, coordinates)) {
+        return cached.op;
+      }
+      mls_operators_.erase(it);
+    }
+    if (mls_operators_.size() >= max_cached_operators) {
+      mls_operators_.erase(mls_operators_.begin());
+    }
+    Kokkos::View<Real*, TargetMemorySpace> coordinates_copy(
+      "mls target coordinates", coordinates.size());
+    Kokkos::deep_copy(
+      coordinates_copy,
+      Kokkos::View<const Real*, TargetMemorySpace,
+                   Kokkos::MemoryTraits<Kokkos::Unmanaged>>(
+        coordinates.data_handle(), coordinates.size()));
+    auto cached = std::make_shared<const Cached>(
+      Cached{coordinates_copy,
+             build_field_mls_operator(*this, method, coordinates)});
+    mls_operators_.emplace_back(key, cached);
+    return cached->op;
+  }
+  [[nodiscard]] size_t NumCachedOperators() const noexcept
+  {
+    return mls_operators_.size();
+  }
+  static constexpr size_t max_cached_operators = 8;
 
 private:
+  void BuildMask()
+  {
+    PCMS_FUNCTION_TIMER;
+    Kokkos::View<int8_t*, HostMemorySpace> mask("mask", data_.size());
+    PCMS_ALWAYS_ASSERT((bool)in_overlap_);
+    for (auto& geom : reverse_classification_) {
+      if (in_overlap_(geom.first.dim, geom.first.id)) {
+        for (auto vert : geom.second) {
+          PCMS_ALWAYS_ASSERT(vert < data_.size());
+          mask(vert) = 1;
+        }
+      }
+    }
+    const auto mask_d =
+      Kokkos::create_mirror_view_and_copy(memory_space{}, mask);
+    mask_ = ArrayMask<memory_space>{make_const_array_view(mask_d)};
+    PCMS_ALWAYS_ASSERT(!mask_.empty());
+    // for host data the mirror is the staging buffer itself
+    staging_ = Kokkos::View<T*, memory_space>("xgc staging", mask_.Size());
+    staging_h_ = Kokkos::create_mirror_view(staging_);
+  }
+  // overlap entries of the buffer in mask order
+  void PackOverlap(ScalarArrayView<const T, HostMemorySpace> buffer,
+                   ScalarArrayView<const pcms::LO, HostMemorySpace> permutation,
+                   T* overlap) const
+  {
+    for (LO i = 0; i < mask_.Size(); ++i) {
+      overlap[i] = buffer[permutation.empty() ? i : permutation[i]];
+    }
+  }
+  // write the overlap entries (in mask order, host memory) into the data
+  void UnpackOverlap(const T* overlap) const
+  {
+    PCMS_FUNCTION_TIMER;
+    const ScalarArrayView<const T, HostMemorySpace> overlap_h(overlap,
+                                                              mask_.Size());
+    if constexpr (std::is_same_v<memory_space, HostMemorySpace>) {
+      mask_.ToFullArray(overlap_h, data_);
+    } else {
+      Kokkos::deep_copy(
+        staging_,
+        Kokkos::View<const T*, HostMemorySpace,
+                     Kokkos::MemoryTraits<Kokkos::Unmanaged>>(overlap,
+                                                              mask_.Size()));
+      mask_.ToFullArray(make_const_array_view(staging_), data_);
+    }
+  }
+  // send the full data of the plane root to all ranks of the plane
+  void BroadcastData() const
+  {
+    PCMS_FUNCTION_TIMER;
+    if constexpr (mpi_accessible_v<memory_space>) {
+      MPI_Bcast(data_.data_handle(), data_.size(),
+                redev::getMpiType(value_type{}), plane_root_, plane_comm_);
+    } else {
+      Kokkos::View<T*, memory_space, Kokkos::MemoryTraits<Kokkos::Unmanaged>>
+        data(data_.data_handle(), data_.size());
+      auto data_h = Kokkos::create_mirror_view(data);
+      if (plane_rank_ == plane_root_) {
+        Kokkos::deep_copy(data_h, data);
+      }
+      MPI_Bcast(data_h.data(), data_h.size(),
+                redev::getMpiType(value_type{}), plane_root_, plane_comm_);
+      if (plane_rank_ != plane_root_) {
+        Kokkos::deep_copy(data, data_h);
+      }
+    }
+  }
+  // host copy of the mask map (see ArrayMask::GetMap)
+  [[nodiscard]] auto HostMaskMap() const
+  {
+    const auto map = mask_.GetMap();
+    return Kokkos::create_mirror_view_and_copy(
+      Kokkos::HostSpace{},
+      Kokkos::View<const LO*, memory_space,
+                   Kokkos::MemoryTraits<Kokkos::Unmanaged>>(map.data_handle(),
+                                                            map.size()));
+  }
+
   std::string name_;
   MPI_Comm plane_comm_;
   int plane_rank_;
@@ -187,6 +548,20 @@ private:
   const ReverseClassificationVertex& reverse_classification_;
   std::function<int8_t(int, int)> in_overlap_;
   ArrayMask<memory_space> mask_;
+  // empty if the adapter was constructed without coordinates
+  Kokkos::View<const CoordinateElementType*, memory_space> coordinates_;
+  // overlap entries staged between the data and the host buffers. Only
+  // allocated on ranks that hold the mask.
+  Kokkos::View<T*, memory_space> staging_;
+  typename Kokkos::View<T*, memory_space>::HostMirror staging_h_;
+  XGCPlaneDistribution plane_distribution_ = XGCPlaneDistribution::Broadcast;
+  // shared so copies of the adapter use the same window
+  std::shared_ptr<detail::NodeSharedBuffer<T>> shared_buffer_;
+  // moving least squares operators to target coordinates. Each entry holds a
+  // detail::CachedMLSOperator in the memory space of the target.
+  mutable std::vector<
+    std::pair<detail::MLSOperatorKey, std::shared_ptr<const void>>>
+    mls_operators_;
   static constexpr int plane_root_{0};
 };
 
@@ -208,51 +583,99 @@ struct ReadXGCNodeClassificationResult
 [[nodiscard]] ReadXGCNodeClassificationResult ReadXGCNodeClassification(
   std::istream& in);
 
-template <typename T, typename CoordinateElementType>
+/// coordinates of all vertices of the plane. Aborts if the adapter was
+/// constructed without coordinates since the field cannot be interpolated.
+template <typename T, typename CoordinateElementType,
+          typename FieldMemorySpace>
 auto get_nodal_coordinates(
-  const XGCFieldAdapter<T, CoordinateElementType>& field)
+  const XGCFieldAdapter<T, CoordinateElementType, FieldMemorySpace>& field)
+  -> Kokkos::View<const CoordinateElementType*, FieldMemorySpace>
 {
   PCMS_FUNCTION_TIMER;
-  Kokkos::View<CoordinateElementType*,
-               typename XGCFieldAdapter<T, CoordinateElementType>::memory_space>
-    coordinates;
-  return coordinates;
+  if (!field.HasCoordinates()) {
+    std::cerr << "XGC field adapter needs coordinates for interpolation!\n";
+    std::abort();
+  }
+  return field.GetCoordinates();
 }
-template <typename T, typename CoordinateElementType, typename MemorySpace>
+
+/// data of all vertices of the plane. Every rank of the plane holds the full
+/// data since Deserialize broadcasts it over the plane communicator.
+template <typename T, typename CoordinateElementType,
+          typename FieldMemorySpace>
+auto get_nodal_data(
+  const XGCFieldAdapter<T, CoordinateElementType, FieldMemorySpace>& field)
+  -> Kokkos::View<const T*, FieldMemorySpace,
+                  Kokkos::MemoryTraits<Kokkos::Unmanaged>>
+{
+  PCMS_FUNCTION_TIMER;
+  const auto data = field.GetData();
+  return {data.data_handle(), data.size()};
+}
+
+/// XGC data has no element connectivity in the adapter, so linear
+/// interpolation is not available. Use NearestNeighbor or MovingLeastSquares.
+template <typename T, typename CoordinateElementType,
+          typename FieldMemorySpace, typename MemorySpace>
 auto evaluate(
-  const XGCFieldAdapter<T, CoordinateElementType>& field,
+  const XGCFieldAdapter<T, CoordinateElementType, FieldMemorySpace>&
+  /* field */,
   Lagrange<1> /* method */,
-  ScalarArrayView<const CoordinateElementType, MemorySpace> coordinates)
+  ScalarArrayView<const CoordinateElementType, MemorySpace> /* coordinates */)
   -> Kokkos::View<T*, MemorySpace>
 {
   PCMS_FUNCTION_TIMER;
-  Kokkos::View<T*, MemorySpace> values("data", coordinates.size() / 2);
-  std::cerr << "Evaluation of XGC Field not implemented yet!\n";
+  std::cerr << "Lagrange<1> evaluation of XGC fields is not supported. Use "
+               "NearestNeighbor or MovingLeastSquares!\n";
   std::abort();
-  return values;
+  return {};
 }
-template <typename T, typename CoordinateElementType, typename MemorySpace>
+/// value of the closest XGC vertex. This is the moving least squares
+/// operator with a single neighbor, which reduces to a unit weight.
+template <typename T, typename CoordinateElementType,
+          typename FieldMemorySpace, typename MemorySpace>
 auto evaluate(
-  const XGCFieldAdapter<T, CoordinateElementType>& field,
+  const XGCFieldAdapter<T, CoordinateElementType, FieldMemorySpace>& field,
   NearestNeighbor /* method */,
   ScalarArrayView<const CoordinateElementType, MemorySpace> coordinates)
   -> Kokkos::View<T*, MemorySpace>
 {
   PCMS_FUNCTION_TIMER;
-  Kokkos::View<T*, MemorySpace> values("data", coordinates.size() / 2);
-  std::cerr << "Evaluation of XGC Field not implemented yet!\n";
-  std::abort();
-  return values;
+  return apply_field_operator(
+    field, field.GetMLSOperator(MovingLeastSquares{1}, coordinates));
+}
+template <typename T, typename CoordinateElementType,
+          typename FieldMemorySpace, typename MemorySpace>
+auto evaluate(
+  const XGCFieldAdapter<T, CoordinateElementType, FieldMemorySpace>& field,
+  MovingLeastSquares method,
+  ScalarArrayView<const CoordinateElementType, MemorySpace> coordinates)
+  -> Kokkos::View<T*, MemorySpace>
+{
+  PCMS_FUNCTION_TIMER;
+  return apply_field_operator(field, field.GetMLSOperator(method, coordinates));
 }
 
-template <typename T, typename CoordinateElementType, typename U>
+/// writes the data of all vertices of the plane
+template <typename T, typename CoordinateElementType,
+          typename FieldMemorySpace, typename U>
 auto set_nodal_data(
-  const XGCFieldAdapter<T, CoordinateElementType>& field,
-  ScalarArrayView<
-    const U, typename XGCFieldAdapter<T, CoordinateElementType>::memory_space>
-    data) -> void
+  const XGCFieldAdapter<T, CoordinateElementType, FieldMemorySpace>& field,
+  ScalarArrayView<const U, FieldMemorySpace> data) -> void
 {
   PCMS_FUNCTION_TIMER;
+  auto field_data = field.GetData();
+  PCMS_ALWAYS_ASSERT(data.size() == field_data.size());
+  Kokkos::parallel_for(
+    Kokkos::RangePolicy<typename FieldMemorySpace::execution_space>(
+      0, data.size()),
+    KOKKOS_LAMBDA(LO i) {
+      if constexpr (std::is_integral_v<T> && !std::is_integral_v<U>) {
+        field_data(i) = std::round(data(i));
+      } else {
+        field_data(i) = data(i);
+      }
+    });
 }
 
 } // namespace pcms
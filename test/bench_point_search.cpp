@@ -0,0 +1,121 @@
+#include <Omega_h_build.hpp>
+#include <Omega_h_library.hpp>
+#include <pcms/point_search.h>
+#include <pcms/types.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <string>
+
+using pcms::BVHPointSearch;
+using pcms::GridPointSearch;
+using pcms::LO;
+using pcms::Real;
+
+inline constexpr int num_trials = 5;
+
+// points spread uniformly over the unit square. Points are generated in
+// random order unless sorted is set, in which case they sweep the square row
+// by row like the vertices of a structured target mesh.
+Kokkos::View<Real* [2]> make_points(LO npoints, bool sorted)
+{
+  Kokkos::View<Real* [2]> points("bench points", npoints);
+  auto points_h = Kokkos::create_mirror_view(points);
+  if (sorted) {
+    const auto npoints_1d =
+      static_cast<LO>(std::ceil(std::sqrt(static_cast<Real>(npoints))));
+    for (LO p = 0; p < npoints; ++p) {
+      points_h(p, 0) = ((p % npoints_1d) + 0.5) / npoints_1d;
+      points_h(p, 1) = ((p / npoints_1d) + 0.5) / npoints_1d;
+    }
+  } else {
+    std::mt19937 gen(42);
+    std::uniform_real_distribution<Real> dist(0.0, 1.0);
+    for (LO p = 0; p < npoints; ++p) {
+      points_h(p, 0) = dist(gen);
+      points_h(p, 1) = dist(gen);
+    }
+  }
+  Kokkos::deep_copy(points, points_h);
+  return points;
+}
+
+// run the search num_trials times and report the best time
+template <typename Search>
+void time_search(const std::string& name, const Search& search,
+                 Kokkos::View<Real* [2]> points)
+{
+  // warm up
+  auto results = search(points);
+  Kokkos::fence();
+  double best = std::numeric_limits<double>::max();
+  for (int i = 0; i < num_trials; ++i) {
+    auto start = std::chrono::steady_clock::now();
+    results = search(points);
+    Kokkos::fence();
+    auto end = std::chrono::steady_clock::now();
+    best = std::min(best, std::chrono::duration<double>(end - start).count());
+  }
+  std::cout << name << ": " << best << " s ("
+            << points.extent(0) / best / 1E6 << " Mpoints/s)\n";
+}
+
+int main(int argc, char** argv)
+{
+  auto lib = Omega_h::Library{&argc, &argv};
+  if (argc > 3) {
+    std::cerr << "Usage: " << argv[0]
+              << " [num_points=4000000] [mesh_divisions=500]\n";
+    return EXIT_FAILURE;
+  }
+  const LO npoints = (argc > 1) ? std::atoi(argv[1]) : 4000000;
+  const LO ndivisions = (argc > 2) ? std::atoi(argv[2]) : 500;
+  auto world = lib.world();
+  auto mesh = Omega_h::build_box(world, OMEGA_H_SIMPLEX, 1, 1, 1, ndivisions,
+                                 ndivisions, 0, false);
+  std::cout << "mesh elements: " << mesh.nelems()
+            << " query points: " << npoints << "\n";
+
+  auto start = std::chrono::steady_clock::now();
+  GridPointSearch grid_search{mesh};
+  auto point1 = std::chrono::steady_clock::now();
+  auto cached_grid_search = GridPointSearch::FromElementsPerCell(
+    mesh, GridPointSearch::default_elements_per_cell, true);
+  auto point2 = std::chrono::steady_clock::now();
+  BVHPointSearch bvh_search{mesh};
+  auto point3 = std::chrono::steady_clock::now();
+  std::cout << "construct grid: "
+            << std::chrono::duration<double>(point1 - start).count() << " s\n";
+  std::cout << "construct grid (inverse basis cache): "
+            << std::chrono::duration<double>(point2 - point1).count()
+            << " s\n";
+  std::cout << "construct bvh: "
+            << std::chrono::duration<double>(point3 - point2).count() << " s\n";
+
+  for (bool sorted : {false, true}) {
+    auto points = make_points(npoints, sorted);
+    const std::string order = sorted ? "sorted" : "random";
+    grid_search.SetQueryMode(GridPointSearch::QueryMode::CandidateScan);
+    cached_grid_search.SetQueryMode(GridPointSearch::QueryMode::CandidateScan);
+    time_search("grid scan " + order, grid_search, points);
+    time_search("grid scan cached " + order, cached_grid_search, points);
+    grid_search.SetQueryMode(GridPointSearch::QueryMode::VectorizedScan);
+    time_search("grid vectorized scan " + order, grid_search, points);
+    grid_search.SetQueryMode(GridPointSearch::QueryMode::Walk);
+    cached_grid_search.SetQueryMode(GridPointSearch::QueryMode::Walk);
+    time_search("grid walk " + order, grid_search, points);
+    time_search("grid walk cached " + order, cached_grid_search, points);
+    time_search("bvh " + order, bvh_search, points);
+    grid_search.SetSortQueries(true);
+    grid_search.SetQueryMode(GridPointSearch::QueryMode::CandidateScan);
+    time_search("grid scan presorted " + order, grid_search, points);
+    grid_search.SetQueryMode(GridPointSearch::QueryMode::Walk);
+    time_search("grid walk presorted " + order, grid_search, points);
+    grid_search.SetSortQueries(false);
+  }
+  return 0;
+}
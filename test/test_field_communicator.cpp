@@ -0,0 +1,205 @@
+#include <catch2/catch_test_macros.hpp>
+#include <pcms/field_communicator.h>
+#include <algorithm>
+#include <memory>
+#include <numeric>
+#include <random>
+
+TEST_CASE("construct permutation from gids", "[field communicator]")
+{
+  static constexpr auto num_gids = 1000;
+  std::vector<pcms::GO> local_gids(num_gids);
+  // gids don't need to be contiguous
+  std::iota(local_gids.begin(), local_gids.end(), 1);
+  std::transform(local_gids.begin(), local_gids.end(), local_gids.begin(),
+                 [](pcms::GO gid) { return 3 * gid; });
+  auto received_gids = local_gids;
+  std::shuffle(received_gids.begin(), received_gids.end(),
+               std::mt19937{42});
+  SECTION("host")
+  {
+    const auto permutation =
+      pcms::detail::ConstructPermutation(local_gids, received_gids);
+    REQUIRE(permutation.size() == received_gids.size());
+    for (size_t i = 0; i < received_gids.size(); ++i) {
+      REQUIRE(local_gids[permutation[i]] == received_gids[i]);
+    }
+  }
+  SECTION("device")
+  {
+    using memory_space = Kokkos::DefaultExecutionSpace::memory_space;
+    using GidView = Kokkos::View<const pcms::GO*, Kokkos::HostSpace,
+                                 Kokkos::MemoryTraits<Kokkos::Unmanaged>>;
+    const auto local_gids_d = Kokkos::create_mirror_view_and_copy(
+      memory_space{}, GidView(local_gids.data(), local_gids.size()));
+    const auto received_gids_d = Kokkos::create_mirror_view_and_copy(
+      memory_space{}, GidView(received_gids.data(), received_gids.size()));
+    const auto permutation = Kokkos::create_mirror_view_and_copy(
+      Kokkos::HostSpace{},
+      pcms::detail::ConstructPermutation<memory_space>(local_gids_d,
+                                                       received_gids_d));
+    REQUIRE(permutation.size() == received_gids.size());
+    for (size_t i = 0; i < received_gids.size(); ++i) {
+      REQUIRE(local_gids[permutation(i)] == received_gids[i]);
+    }
+  }
+}
+
+TEST_CASE("field layout cache", "[field communicator]")
+{
+  std::vector<pcms::GO> gids(100);
+  std::iota(gids.begin(), gids.end(), 0);
+  auto layout = std::make_shared<pcms::detail::FieldLayout>();
+  layout->num_gids = gids.size();
+  layout->gid_hash = pcms::detail::HashGids(gids);
+  layout->participates = true;
+  auto null_layout = std::make_shared<pcms::detail::FieldLayout>();
+  SECTION("fields with the same layout name share the layout")
+  {
+    pcms::FieldLayoutCache cache(MPI_COMM_SELF);
+    REQUIRE(cache.Find("overlap", true) == nullptr);
+    cache.Insert("overlap", layout);
+    REQUIRE(cache.Size() == 1);
+    REQUIRE(cache.Find("overlap", true) == layout);
+    REQUIRE(cache.Find("overlap", true) == cache.Find("overlap", true));
+    REQUIRE(cache.Find("other", true) == nullptr);
+  }
+  SECTION("null layouts are only shared by non participating fields")
+  {
+    pcms::FieldLayoutCache cache;
+    cache.Insert("overlap", null_layout);
+    REQUIRE(cache.Find("overlap", false) == null_layout);
+    REQUIRE(cache.Find("overlap", true) == nullptr);
+    // the participating field constructs its layout and replaces the entry
+    cache.Insert("overlap", layout);
+    REQUIRE(cache.Size() == 1);
+    REQUIRE(cache.Find("overlap", true) == layout);
+    REQUIRE(cache.Find("overlap", false) == nullptr);
+  }
+  SECTION("reused layouts must have the same gids")
+  {
+    REQUIRE(pcms::detail::LayoutMatchesGids(*layout, gids));
+    auto permuted_gids = gids;
+    std::reverse(permuted_gids.begin(), permuted_gids.end());
+    REQUIRE(!pcms::detail::LayoutMatchesGids(*layout, permuted_gids));
+    auto fewer_gids = gids;
+    fewer_gids.pop_back();
+    REQUIRE(!pcms::detail::LayoutMatchesGids(*layout, fewer_gids));
+    auto other_gids = gids;
+    other_gids[10] = 1000;
+    REQUIRE(!pcms::detail::LayoutMatchesGids(*layout, other_gids));
+  }
+}
+
+TEST_CASE("reverse partition counting sort", "[field communicator]")
+{
+  static constexpr auto num_indices = 1000;
+  std::vector<pcms::LO> index_ranks(num_indices);
+  std::mt19937 generator{42};
+  // skip some ranks so that not every rank receives data
+  std::uniform_int_distribution<pcms::LO> distribution(0, 7);
+  std::generate(index_ranks.begin(), index_ranks.end(),
+                [&] { return 2 * distribution(generator); });
+  pcms::ReversePartitionMap reverse_partition_map;
+  for (pcms::LO i = 0; i < num_indices; ++i) {
+    reverse_partition_map[index_ranks[i]].push_back(i);
+  }
+  const auto reverse_partition = pcms::MakeReversePartition(index_ranks);
+  const auto converted = pcms::MakeReversePartition(reverse_partition_map);
+  REQUIRE(reverse_partition.ranks == converted.ranks);
+  REQUIRE(reverse_partition.offsets == converted.offsets);
+  REQUIRE(reverse_partition.indices == converted.indices);
+  REQUIRE(reverse_partition.offsets.size() ==
+          reverse_partition.ranks.size() + 1);
+  REQUIRE(reverse_partition.offsets.back() == num_indices);
+  const auto out_message =
+    pcms::detail::ConstructOutMessage(reverse_partition);
+  const auto out_message_map =
+    pcms::detail::ConstructOutMessage(reverse_partition_map);
+  REQUIRE(out_message.dest == out_message_map.dest);
+  REQUIRE(out_message.offset == out_message_map.offset);
+  REQUIRE(pcms::detail::ConstructPermutation(reverse_partition) ==
+          pcms::detail::ConstructPermutation(reverse_partition_map));
+}
+
+namespace
+{
+struct TestPackableField final : public pcms::detail::PackableField<int>
+{
+  [[nodiscard]] std::shared_ptr<const pcms::detail::FieldLayout> GetLayout()
+    const noexcept final
+  {
+    return layout;
+  }
+  [[nodiscard]] MPI_Comm GetMPIComm() const noexcept final
+  {
+    return MPI_COMM_SELF;
+  }
+  [[nodiscard]] pcms::ScalarArrayView<const int, pcms::HostMemorySpace> Pack()
+    final
+  {
+    return pcms::make_const_array_view(data);
+  }
+  void Unpack(pcms::ScalarArrayView<const int, pcms::HostMemorySpace> received)
+    final
+  {
+    unpacked.assign(received.data_handle(),
+                    received.data_handle() + received.size());
+  }
+  std::shared_ptr<const pcms::detail::FieldLayout> layout;
+  std::vector<int> data;
+  std::vector<int> unpacked;
+};
+} // namespace
+
+TEST_CASE("field group packing", "[field communicator]")
+{
+  static constexpr int num_fields = 3;
+  static constexpr int num_entries = 5;
+  auto layout = std::make_shared<pcms::detail::FieldLayout>();
+  layout->out_message.dest = {1, 3};
+  layout->out_message.offset = {0, 2, num_entries};
+  std::vector<TestPackableField> fields(num_fields);
+  std::vector<pcms::detail::PackableFieldBase*> type_erased_fields;
+  for (int j = 0; j < num_fields; ++j) {
+    fields[j].layout = layout;
+    fields[j].data.resize(num_entries);
+    for (int i = 0; i < num_entries; ++i) {
+      fields[j].data[i] = 100 * j + i;
+    }
+    type_erased_fields.push_back(&fields[j]);
+  }
+  const auto packable_fields =
+    pcms::detail::CastPackableFields<int>("group", type_erased_fields);
+  REQUIRE(packable_fields.size() == num_fields);
+  SECTION("pack and unpack round trip")
+  {
+    std::vector<int> buffer(num_fields * num_entries);
+    pcms::detail::PackFields(packable_fields, buffer);
+    for (int i = 0; i < num_entries; ++i) {
+      for (int j = 0; j < num_fields; ++j) {
+        REQUIRE(buffer[i * num_fields + j] == 100 * j + i);
+      }
+    }
+    std::vector<int> scratch;
+    pcms::detail::UnpackFields(buffer, packable_fields, scratch);
+    for (const auto& field : fields) {
+      REQUIRE(field.unpacked == field.data);
+    }
+  }
+  SECTION("group message layout")
+  {
+    const auto out_message =
+      pcms::detail::ScaleOutMessage(layout->out_message, num_fields);
+    REQUIRE(out_message.dest == layout->out_message.dest);
+    REQUIRE(out_message.offset ==
+            redev::LOs{0, 2 * num_fields, num_entries * num_fields});
+    REQUIRE(pcms::detail::HaveSameMessageLayout(*layout, *layout));
+    auto other_layout = *layout;
+    other_layout.out_message.offset = {0, 3, num_entries};
+    REQUIRE(!pcms::detail::HaveSameMessageLayout(*layout, other_layout));
+    other_layout = *layout;
+    other_layout.out_message.dest = {1, 2};
+    REQUIRE(!pcms::detail::HaveSameMessageLayout(*layout, other_layout));
+  }
+}
@@ -1,9 +1,14 @@
 #include <pcms/transfer_field.h>
 #include <pcms/omega_h_field.h>
 #include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_approx.hpp>
 #include <Omega_h_mesh.hpp>
 #include <Omega_h_build.hpp>
 #include <Kokkos_Core.hpp>
+#include <algorithm>
+#include <cmath>
+#include <optional>
+#include <string>
 
 TEST_CASE("field copy", "[field transfer]")
 {
@@ -67,3 +72,376 @@ TEST_CASE("field interpolation (identical fields)", "[field transfer]")
     REQUIRE(result == n * (n + 1) / 2);
   }
 }
+
+TEST_CASE("field interpolation (Lagrange<2>)", "[field transfer]")
+{
+  Omega_h::Library lib;
+  auto source_mesh =
+    Omega_h::build_box(lib.world(), OMEGA_H_SIMPLEX, 1, 1, 1, 10, 10, 0, false);
+  auto target_mesh =
+    Omega_h::build_box(lib.world(), OMEGA_H_SIMPLEX, 1, 1, 1, 7, 7, 0, false);
+  const auto quadratic = [](pcms::Real x, pcms::Real y) {
+    return x * x + x * y - 2 * y * y;
+  };
+  auto set_quadratic = [&](Omega_h::Mesh& mesh, int dim) {
+    const auto nents = mesh.nents(dim);
+    Omega_h::HostRead<pcms::Real> coords(mesh.coords());
+    Omega_h::HostRead<pcms::LO> ents2verts(mesh.ask_verts_of(dim));
+    Omega_h::HostWrite<pcms::Real> values(nents);
+    for (int i = 0; i < nents; ++i) {
+      pcms::Real x = 0;
+      pcms::Real y = 0;
+      for (int j = 0; j <= dim; ++j) {
+        x += coords[2 * ents2verts[(dim + 1) * i + j]] / (dim + 1);
+        y += coords[2 * ents2verts[(dim + 1) * i + j] + 1] / (dim + 1);
+      }
+      values[i] = quadratic(x, y);
+    }
+    mesh.add_tag<pcms::Real>(dim, "source", 1, Omega_h::Reals(values.write()));
+  };
+  set_quadratic(source_mesh, 0);
+  pcms::OmegaHField<pcms::Real> source("source", source_mesh);
+  source.ConstructSearch();
+  pcms::OmegaHField<pcms::Real> target("target", target_mesh);
+  Omega_h::HostRead<pcms::Real> target_coords(target_mesh.coords());
+  // max error over the target vertices at least margin from the boundary
+  const auto max_error = [&](pcms::Real margin) {
+    Omega_h::HostRead<pcms::Real> target_values(
+      target_mesh.get_array<pcms::Real>(0, "target"));
+    pcms::Real error = 0;
+    for (int i = 0; i < target_mesh.nverts(); ++i) {
+      const auto x = target_coords[2 * i];
+      const auto y = target_coords[2 * i + 1];
+      if (std::min({x, y, 1 - x, 1 - y}) < margin) {
+        continue;
+      }
+      error = std::max(error, std::abs(target_values[i] - quadratic(x, y)));
+    }
+    return error;
+  };
+  pcms::interpolate_field(source, target, pcms::Lagrange<1>{});
+  const auto linear_error = max_error(0.2);
+  REQUIRE(linear_error > 1E-4);
+  SECTION("recovered edge values")
+  {
+    // the recovered gradients are less accurate on the boundary
+    pcms::transfer_field(source, target, pcms::FieldTransferMethod::Interpolate,
+                         pcms::FieldEvaluationMethod::Lagrange2);
+    REQUIRE(max_error(0.2) < linear_error / 2);
+  }
+  SECTION("edge midpoint data")
+  {
+    set_quadratic(source_mesh, 1);
+    pcms::transfer_field(source, target, pcms::FieldTransferMethod::Interpolate,
+                         pcms::FieldEvaluationMethod::Lagrange2);
+    REQUIRE(max_error(0) < 1E-12);
+  }
+}
+
+TEST_CASE("interpolation operator is reused across target fields",
+          "[field transfer]")
+{
+  Omega_h::Library lib;
+  auto source_mesh =
+    Omega_h::build_box(lib.world(), OMEGA_H_SIMPLEX, 1, 1, 1, 10, 10, 0, false);
+  auto target_mesh =
+    Omega_h::build_box(lib.world(), OMEGA_H_SIMPLEX, 1, 1, 1, 7, 7, 0, false);
+  Omega_h::HostRead<pcms::Real> source_coords(source_mesh.coords());
+  Omega_h::HostWrite<pcms::Real> values(source_mesh.nverts());
+  for (int i = 0; i < source_mesh.nverts(); ++i) {
+    values[i] = 2 * source_coords[2 * i] - source_coords[2 * i + 1];
+  }
+  source_mesh.add_tag<pcms::Real>(0, "source", 1,
+                                  Omega_h::Reals(values.write()));
+  pcms::OmegaHField<pcms::Real> source("source", source_mesh);
+  source.ConstructSearch();
+  REQUIRE(source.NumInterpolationOperators() == 0);
+  auto coordinates = target_mesh.coords();
+  Omega_h::HostRead<pcms::Real> expected(pcms::evaluate(
+    source, pcms::Lagrange<1>{}, pcms::make_const_array_view(coordinates)));
+  // each transfer uses a new target field object on the same vertices, as the
+  // server does when converting into a temporary internal field
+  for (int transfer = 0; transfer < 2; ++transfer) {
+    pcms::OmegaHField<pcms::Real> target("target", target_mesh);
+    pcms::interpolate_field(source, target, pcms::Lagrange<1>{});
+    REQUIRE(source.NumInterpolationOperators() == 1);
+    Omega_h::HostRead<pcms::Real> result(
+      target_mesh.get_array<pcms::Real>(0, "target"));
+    REQUIRE(result.size() == expected.size());
+    for (int i = 0; i < result.size(); ++i) {
+      REQUIRE(result[i] == Catch::Approx(expected[i]));
+    }
+  }
+}
+
+TEST_CASE("interpolation operator is rebuilt after the target mesh changes",
+          "[field transfer]")
+{
+  Omega_h::Library lib;
+  auto source_mesh =
+    Omega_h::build_box(lib.world(), OMEGA_H_SIMPLEX, 1, 1, 1, 10, 10, 0, false);
+  auto target_mesh =
+    Omega_h::build_box(lib.world(), OMEGA_H_SIMPLEX, 1, 1, 1, 7, 7, 0, false);
+  const auto linear = [](pcms::Real x, pcms::Real y) { return 3 * x + y; };
+  Omega_h::HostRead<pcms::Real> source_coords(source_mesh.coords());
+  Omega_h::HostWrite<pcms::Real> values(source_mesh.nverts());
+  for (int i = 0; i < source_mesh.nverts(); ++i) {
+    values[i] = linear(source_coords[2 * i], source_coords[2 * i + 1]);
+  }
+  source_mesh.add_tag<pcms::Real>(0, "source", 1,
+                                  Omega_h::Reals(values.write()));
+  pcms::OmegaHField<pcms::Real> source("source", source_mesh);
+  source.ConstructSearch();
+  pcms::OmegaHField<pcms::Real> target("target", target_mesh);
+  const auto check_target = [&]() {
+    Omega_h::HostRead<pcms::Real> coords(target_mesh.coords());
+    Omega_h::HostRead<pcms::Real> result(
+      target_mesh.get_array<pcms::Real>(0, "target"));
+    for (int i = 0; i < target_mesh.nverts(); ++i) {
+      REQUIRE(result[i] ==
+              Catch::Approx(linear(coords[2 * i], coords[2 * i + 1])));
+    }
+  };
+  pcms::interpolate_field(source, target, pcms::Lagrange<1>{});
+  check_target();
+  // move the target vertices in place. The operator cached on the source
+  // field must not be reused once the target field is invalidated.
+  Omega_h::HostRead<pcms::Real> target_coords(target_mesh.coords());
+  Omega_h::HostWrite<pcms::Real> moved(target_coords.size());
+  for (int i = 0; i < target_coords.size(); ++i) {
+    moved[i] = 0.25 + 0.5 * target_coords[i];
+  }
+  target_mesh.set_coords(Omega_h::Reals(moved.write()));
+  target.InvalidateCaches();
+  pcms::interpolate_field(source, target, pcms::Lagrange<1>{});
+  check_target();
+  // the operator to the old vertices was dropped
+  REQUIRE(source.NumInterpolationOperators() == 1);
+}
+
+static pcms::Real integrate_linear_field(Omega_h::Mesh& mesh,
+                                         const std::string& name)
+{
+  Omega_h::HostRead<pcms::Real> coords(mesh.coords());
+  Omega_h::HostRead<pcms::LO> tris2verts(mesh.ask_elem_verts());
+  Omega_h::HostRead<pcms::Real> values(mesh.get_array<pcms::Real>(0, name));
+  pcms::Real integral = 0;
+  for (int e = 0; e < mesh.nelems(); ++e) {
+    const auto a = tris2verts[3 * e];
+    const auto b = tris2verts[3 * e + 1];
+    const auto c = tris2verts[3 * e + 2];
+    const auto area = std::abs((coords[2 * b] - coords[2 * a]) *
+                                 (coords[2 * c + 1] - coords[2 * a + 1]) -
+                               (coords[2 * c] - coords[2 * a]) *
+                                 (coords[2 * b + 1] - coords[2 * a + 1])) /
+                      2;
+    integral += area * (values[a] + values[b] + values[c]) / 3;
+  }
+  return integral;
+}
+
+TEST_CASE("conservative field transfer", "[field transfer]")
+{
+  Omega_h::Library lib;
+  auto source_mesh =
+    Omega_h::build_box(lib.world(), OMEGA_H_SIMPLEX, 1, 1, 1, 10, 10, 0, false);
+  auto target_mesh =
+    Omega_h::build_box(lib.world(), OMEGA_H_SIMPLEX, 1, 1, 1, 7, 7, 0, false);
+  SECTION("triangle intersection area")
+  {
+    Omega_h::Matrix<2, 3> a{{0, 0}, {1, 0}, {0, 1}};
+    Omega_h::Matrix<2, 3> b{{0, 0}, {1, 0}, {1, 1}};
+    REQUIRE(pcms::detail::triangle_intersection_area(a, a) ==
+            Catch::Approx(0.5));
+    REQUIRE(pcms::detail::triangle_intersection_area(a, b) ==
+            Catch::Approx(0.25));
+    Omega_h::Matrix<2, 3> c{{2, 2}, {3, 2}, {2, 3}};
+    REQUIRE(pcms::detail::triangle_intersection_area(a, c) == 0);
+  }
+  SECTION("integral is preserved")
+  {
+    Omega_h::HostRead<pcms::Real> coords(source_mesh.coords());
+    Omega_h::HostWrite<pcms::Real> values(source_mesh.nverts());
+    for (int i = 0; i < source_mesh.nverts(); ++i) {
+      const auto x = coords[2 * i];
+      const auto y = coords[2 * i + 1];
+      values[i] = 1 + std::sin(6 * x) * y * y;
+    }
+    source_mesh.add_tag<pcms::Real>(0, "density", 1,
+                                    Omega_h::Reals(values.write()));
+    pcms::OmegaHField<pcms::Real> source("density", source_mesh);
+    pcms::OmegaHField<pcms::Real> target("density", target_mesh);
+    pcms::transfer_field(source, target,
+                         pcms::FieldTransferMethod::Conservative,
+                         pcms::FieldEvaluationMethod::None);
+    REQUIRE(integrate_linear_field(target_mesh, "density") ==
+            Catch::Approx(integrate_linear_field(source_mesh, "density"))
+              .epsilon(1E-12));
+  }
+  SECTION("constant field is reproduced")
+  {
+    source_mesh.add_tag<pcms::Real>(0, "constant", 1,
+                                    Omega_h::Reals(source_mesh.nverts(), 3.0));
+    pcms::OmegaHField<pcms::Real> source("constant", source_mesh);
+    pcms::OmegaHField<pcms::Real> target("constant", target_mesh);
+    pcms::transfer_field(source, target,
+                         pcms::FieldTransferMethod::Conservative,
+                         pcms::FieldEvaluationMethod::None);
+    Omega_h::HostRead<pcms::Real> target_values(
+      target_mesh.get_array<pcms::Real>(0, "constant"));
+    for (int i = 0; i < target_values.size(); ++i) {
+      REQUIRE(target_values[i] == Catch::Approx(3.0));
+    }
+  }
+}
+
+TEST_CASE("field interpolation (moving least squares)", "[field transfer]")
+{
+  Omega_h::Library lib;
+  auto source_mesh =
+    Omega_h::build_box(lib.world(), OMEGA_H_SIMPLEX, 1, 1, 1, 10, 10, 0, false);
+  auto target_mesh =
+    Omega_h::build_box(lib.world(), OMEGA_H_SIMPLEX, 1, 1, 1, 7, 7, 0, false);
+  const auto linear = [](pcms::Real x, pcms::Real y) {
+    return 1 + 2 * x - 3 * y;
+  };
+  Omega_h::HostRead<pcms::Real> source_coords(source_mesh.coords());
+  Omega_h::HostWrite<pcms::Real> values(source_mesh.nverts());
+  for (int i = 0; i < source_mesh.nverts(); ++i) {
+    values[i] = linear(source_coords[2 * i], source_coords[2 * i + 1]);
+  }
+  source_mesh.add_tag<pcms::Real>(0, "linear", 1,
+                                  Omega_h::Reals(values.write()));
+  pcms::OmegaHField<pcms::Real> source("linear", source_mesh);
+  Omega_h::HostRead<pcms::Real> target_coords(target_mesh.coords());
+  // the fit reproduces linear fields, also near the boundary where the
+  // neighbors are all on one side
+  SECTION("transfer between meshes")
+  {
+    pcms::OmegaHField<pcms::Real> target("linear", target_mesh);
+    pcms::transfer_field(source, target, pcms::FieldTransferMethod::Interpolate,
+                         pcms::FieldEvaluationMethod::MovingLeastSquares);
+    Omega_h::HostRead<pcms::Real> target_values(
+      target_mesh.get_array<pcms::Real>(0, "linear"));
+    for (int i = 0; i < target_mesh.nverts(); ++i) {
+      REQUIRE(target_values[i] ==
+              Catch::Approx(linear(target_coords[2 * i],
+                                   target_coords[2 * i + 1]))
+                .margin(1E-10));
+    }
+  }
+  SECTION("mesh free evaluation")
+  {
+    Kokkos::View<pcms::Real*> coordinates("coordinates", target_coords.size());
+    Kokkos::deep_copy(
+      coordinates,
+      Kokkos::View<const pcms::Real*, Kokkos::HostSpace,
+                   Kokkos::MemoryTraits<Kokkos::Unmanaged>>(
+        target_coords.data(), target_coords.size()));
+    const auto target_values = Kokkos::create_mirror_view_and_copy(
+      Kokkos::HostSpace{},
+      pcms::evaluate_mls(source, pcms::MovingLeastSquares{6},
+                         pcms::make_const_array_view(coordinates)));
+    REQUIRE(static_cast<int>(target_values.size()) == target_mesh.nverts());
+    for (int i = 0; i < target_mesh.nverts(); ++i) {
+      REQUIRE(target_values(i) ==
+              Catch::Approx(linear(target_coords[2 * i],
+                                   target_coords[2 * i + 1]))
+                .margin(1E-10));
+    }
+  }
+}
+
+TEST_CASE("interpolation operator is keyed by the method parameters",
+          "[field transfer]")
+{
+  Omega_h::Library lib;
+  auto source_mesh =
+    Omega_h::build_box(lib.world(), OMEGA_H_SIMPLEX, 1, 1, 1, 10, 10, 0, false);
+  auto target_mesh =
+    Omega_h::build_box(lib.world(), OMEGA_H_SIMPLEX, 1, 1, 1, 7, 7, 0, false);
+  // the fit of a nonlinear field depends on the number of neighbors
+  Omega_h::HostRead<pcms::Real> source_coords(source_mesh.coords());
+  Omega_h::HostWrite<pcms::Real> values(source_mesh.nverts());
+  for (int i = 0; i < source_mesh.nverts(); ++i) {
+    const auto x = source_coords[2 * i];
+    const auto y = source_coords[2 * i + 1];
+    values[i] = x * x * y + std::sin(5 * x);
+  }
+  source_mesh.add_tag<pcms::Real>(0, "source", 1,
+                                  Omega_h::Reals(values.write()));
+  pcms::OmegaHField<pcms::Real> source("source", source_mesh);
+  pcms::OmegaHField<pcms::Real> target("target", target_mesh);
+  auto coordinates = target_mesh.coords();
+  const auto check_target = [&](pcms::MovingLeastSquares method) {
+    Omega_h::HostRead<pcms::Real> expected(pcms::evaluate(
+      source, method, pcms::make_const_array_view(coordinates)));
+    Omega_h::HostRead<pcms::Real> result(
+      target_mesh.get_array<pcms::Real>(0, "target"));
+    REQUIRE(result.size() == expected.size());
+    for (int i = 0; i < result.size(); ++i) {
+      REQUIRE(result[i] == Catch::Approx(expected[i]));
+    }
+  };
+  pcms::interpolate_field(source, target, pcms::MovingLeastSquares{12});
+  check_target(pcms::MovingLeastSquares{12});
+  REQUIRE(source.NumInterpolationOperators() == 1);
+  pcms::interpolate_field(source, target, pcms::MovingLeastSquares{6});
+  check_target(pcms::MovingLeastSquares{6});
+  REQUIRE(source.NumInterpolationOperators() == 2);
+  pcms::interpolate_field(source, target, pcms::MovingLeastSquares{12});
+  check_target(pcms::MovingLeastSquares{12});
+  REQUIRE(source.NumInterpolationOperators() == 2);
+}
+
+TEST_CASE("interpolation operator cache only holds live targets",
+          "[field transfer]")
+{
+  Omega_h::Library lib;
+  auto source_mesh =
+    Omega_h::build_box(lib.world(), OMEGA_H_SIMPLEX, 1, 1, 1, 10, 10, 0, false);
+  const auto linear = [](pcms::Real x, pcms::Real y) { return x - 2 * y; };
+  Omega_h::HostRead<pcms::Real> source_coords(source_mesh.coords());
+  Omega_h::HostWrite<pcms::Real> values(source_mesh.nverts());
+  for (int i = 0; i < source_mesh.nverts(); ++i) {
+    values[i] = linear(source_coords[2 * i], source_coords[2 * i + 1]);
+  }
+  source_mesh.add_tag<pcms::Real>(0, "source", 1,
+                                  Omega_h::Reals(values.write()));
+  pcms::OmegaHField<pcms::Real> source("source", source_mesh);
+  source.ConstructSearch();
+  std::optional<Omega_h::Mesh> target_mesh;
+  const auto check_target = [&]() {
+    Omega_h::HostRead<pcms::Real> coords(target_mesh->coords());
+    Omega_h::HostRead<pcms::Real> result(
+      target_mesh->get_array<pcms::Real>(0, "target"));
+    for (int i = 0; i < target_mesh->nverts(); ++i) {
+      REQUIRE(result[i] ==
+              Catch::Approx(linear(coords[2 * i], coords[2 * i + 1])));
+    }
+  };
+  SECTION("masked targets built on the fly")
+  {
+    target_mesh.emplace(Omega_h::build_box(lib.world(), OMEGA_H_SIMPLEX, 1, 1,
+                                           1, 7, 7, 0, false));
+    Omega_h::Read<Omega_h::I8> mask(target_mesh->nverts(), 1);
+    for (int transfer = 0; transfer < 3; ++transfer) {
+      pcms::OmegaHField<pcms::Real> target("target", *target_mesh, mask);
+      pcms::interpolate_field(source, target, pcms::Lagrange<1>{});
+      // the operators to the targets of earlier iterations were dropped
+      REQUIRE(source.NumInterpolationOperators() == 1);
+    }
+  }
+  SECTION("mesh rebuilt at the same address")
+  {
+    for (pcms::Real scale : {1.0, 0.5}) {
+      // same number of vertices at different coordinates
+      target_mesh.emplace(Omega_h::build_box(
+        lib.world(), OMEGA_H_SIMPLEX, scale, scale, 1, 7, 7, 0, false));
+      pcms::OmegaHField<pcms::Real> target("target", *target_mesh);
+      pcms::interpolate_field(source, target, pcms::Lagrange<1>{});
+      check_target();
+      REQUIRE(source.NumInterpolationOperators() == 1);
+    }
+  }
+}
@@ -71,3 +71,149 @@ TEST_CASE("copy omega_h_field data")
     REQUIRE(sum == original_array.size());
   }
 }
+
+TEST_CASE("serialize omega_h field adapter")
+{
+  auto lib = Omega_h::Library{};
+  auto world = lib.world();
+  auto mesh =
+    Omega_h::build_box(world, OMEGA_H_SIMPLEX, 1, 1, 1, 10, 10, 0, false);
+  const auto nverts = mesh.nents(0);
+  Omega_h::Write<int> ids(nverts);
+  Omega_h::parallel_for(
+    nverts, OMEGA_H_LAMBDA(int i) { ids[i] = i; });
+  mesh.add_tag<int>(0, "test_ids", 1, Omega_h::Read(ids));
+  Omega_h::Write<Omega_h::I8> mask(nverts, 0);
+  Omega_h::parallel_for(
+    nverts, OMEGA_H_LAMBDA(int i) { mask[i] = i % 2; });
+  pcms::OmegaHFieldAdapter<int> adapter("test_ids", mesh, mask);
+  const int size = adapter.Serialize({}, {});
+  REQUIRE(size == nverts / 2);
+  // reverse the order of the masked entries
+  std::vector<pcms::LO> permutation(size);
+  for (int i = 0; i < size; ++i) {
+    permutation[i] = size - 1 - i;
+  }
+  std::vector<int> buffer(size);
+  for (int repeat = 0; repeat < 2; ++repeat) {
+    REQUIRE(adapter.Serialize(pcms::make_array_view(buffer),
+                              pcms::make_const_array_view(permutation)) ==
+            size);
+    for (int i = 0; i < size; ++i) {
+      // masked entry j is vertex 2j+1
+      REQUIRE(buffer[i] == 2 * permutation[i] + 1);
+    }
+  }
+}
+
+TEST_CASE("deserialize omega_h field adapter")
+{
+  auto lib = Omega_h::Library{};
+  auto world = lib.world();
+  auto mesh =
+    Omega_h::build_box(world, OMEGA_H_SIMPLEX, 1, 1, 1, 10, 10, 0, false);
+  const auto nverts = mesh.nents(0);
+  mesh.add_tag<int>(0, "received", 1, Omega_h::Read<int>(nverts, -1));
+  Omega_h::Write<Omega_h::I8> mask(nverts, 0);
+  Omega_h::parallel_for(
+    nverts, OMEGA_H_LAMBDA(int i) { mask[i] = i % 2; });
+  pcms::OmegaHFieldAdapter<int> adapter("received", mesh, mask);
+  const int size = adapter.Serialize({}, {});
+  std::vector<pcms::LO> permutation(size);
+  for (int i = 0; i < size; ++i) {
+    permutation[i] = size - 1 - i;
+  }
+  std::vector<int> buffer(size);
+  const int* tag_data = nullptr;
+  for (int repeat = 0; repeat < 2; ++repeat) {
+    for (int i = 0; i < size; ++i) {
+      buffer[i] = repeat * 1000 + i;
+    }
+    adapter.Deserialize(pcms::make_const_array_view(buffer),
+                        pcms::make_const_array_view(permutation));
+    const auto received = mesh.get_array<int>(0, "received");
+    // the second call writes into the same array
+    if (repeat == 0) {
+      tag_data = received.data();
+    }
+    REQUIRE(received.data() == tag_data);
+    Omega_h::HostRead<int> received_h(received);
+    for (int i = 0; i < size; ++i) {
+      // masked entry j is vertex 2j+1
+      REQUIRE(received_h[2 * permutation[i] + 1] == buffer[i]);
+    }
+    for (int v = 0; v < nverts; v += 2) {
+      REQUIRE(received_h[v] == -1);
+    }
+  }
+}
+
+TEST_CASE("omega_h field adapters share the tag array")
+{
+  auto lib = Omega_h::Library{};
+  auto world = lib.world();
+  auto mesh =
+    Omega_h::build_box(world, OMEGA_H_SIMPLEX, 1, 1, 1, 10, 10, 0, false);
+  const auto nverts = mesh.nents(0);
+  Omega_h::Write<Omega_h::I8> even(nverts, 0);
+  Omega_h::Write<Omega_h::I8> odd(nverts, 0);
+  Omega_h::parallel_for(
+    nverts, OMEGA_H_LAMBDA(int i) {
+      even[i] = (i % 2 == 0);
+      odd[i] = (i % 2 == 1);
+    });
+  // two adapters on the same tag, e.g. the same field received from two
+  // applications on different parts of the mesh
+  pcms::OmegaHFieldAdapter<int> even_adapter("shared", mesh, even);
+  pcms::OmegaHFieldAdapter<int> odd_adapter("shared", mesh, odd);
+  const int even_size = even_adapter.Serialize({}, {});
+  const int odd_size = odd_adapter.Serialize({}, {});
+  const int* tag_data = nullptr;
+  for (int repeat = 0; repeat < 2; ++repeat) {
+    std::vector<int> even_buffer(even_size, repeat * 10);
+    std::vector<int> odd_buffer(odd_size, repeat * 10 + 1);
+    even_adapter.Deserialize(pcms::make_const_array_view(even_buffer), {});
+    odd_adapter.Deserialize(pcms::make_const_array_view(odd_buffer), {});
+    const auto shared = mesh.get_array<int>(0, "shared");
+    // neither adapter replaces the array the other one writes into
+    if (repeat == 0) {
+      tag_data = shared.data();
+    }
+    REQUIRE(shared.data() == tag_data);
+    Omega_h::HostRead<int> shared_h(shared);
+    for (int v = 0; v < nverts; ++v) {
+      REQUIRE(shared_h[v] == repeat * 10 + v % 2);
+    }
+  }
+}
+
+TEST_CASE("omega_h field caches derived arrays")
+{
+  auto lib = Omega_h::Library{};
+  auto world = lib.world();
+  auto mesh =
+    Omega_h::build_box(world, OMEGA_H_SIMPLEX, 1, 1, 1, 10, 10, 0, false);
+  const auto nverts = mesh.nents(0);
+  Omega_h::Write<Omega_h::I8> mask(nverts, 0);
+  Omega_h::parallel_for(
+    nverts, OMEGA_H_LAMBDA(int i) { mask[i] = i % 2; });
+  pcms::OmegaHField<int, double> field("cached", mesh, mask);
+  const auto gids = field.GetGids();
+  const auto coordinates = field.GetCoordinates();
+  REQUIRE(gids.size() == field.Size());
+  REQUIRE(coordinates.size() == 2 * field.Size());
+  REQUIRE(field.GetGids().data() == gids.data());
+  REQUIRE(field.GetClassIDs().data() == field.GetClassIDs().data());
+  REQUIRE(field.GetClassDims().data() == field.GetClassDims().data());
+  REQUIRE(pcms::get_nodal_coordinates(field).data() == coordinates.data());
+  field.ConstructSearch(10, 10);
+  field.InvalidateCaches();
+  REQUIRE(!field.HasSearch());
+  const auto rebuilt_gids = field.GetGids();
+  REQUIRE(rebuilt_gids.data() != gids.data());
+  Omega_h::HostRead<Omega_h::GO> gids_h(gids);
+  Omega_h::HostRead<Omega_h::GO> rebuilt_gids_h(rebuilt_gids);
+  for (int i = 0; i < field.Size(); ++i) {
+    REQUIRE(gids_h[i] == rebuilt_gids_h[i]);
+  }
+}
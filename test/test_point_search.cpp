@@ -3,6 +3,7 @@
 #include <pcms/point_search.h>
 #include <Omega_h_mesh.hpp>
 #include <Omega_h_build.hpp>
+#include <vector>
 
 using pcms::AABBox;
 using pcms::barycentric_from_global;
@@ -157,6 +158,34 @@ TEST_CASE("construct intersection map")
     REQUIRE(intersection_map.numRows() == 3600);
     REQUIRE(num_candidates_within_range(intersection_map, 1, 6));
   }
+  SECTION("matches brute force")
+  {
+    Kokkos::View<UniformGrid[1]> grid_d("uniform grid");
+    auto grid_h = Kokkos::create_mirror_view(grid_d);
+    grid_h(0) = UniformGrid{.edge_length{1, 1}, .bot_left = {0, 0}, .divisions = {7, 13}};
+    Kokkos::deep_copy(grid_d, grid_h);
+    auto intersection_map = pcms::detail::construct_intersection_map(mesh, grid_d, grid_h(0).GetNumCells());
+    auto row_map = Kokkos::create_mirror_view_and_copy(Kokkos::HostSpace{}, intersection_map.row_map);
+    auto entries = Kokkos::create_mirror_view_and_copy(Kokkos::HostSpace{}, intersection_map.entries);
+    auto tris2verts = Omega_h::HostRead<Omega_h::LO>(mesh.ask_elem_verts());
+    auto coords = Omega_h::HostRead<Omega_h::Real>(mesh.coords());
+    for (int cell = 0; cell < grid_h(0).GetNumCells(); ++cell) {
+      std::vector<pcms::LO> expected;
+      for (int elem = 0; elem < mesh.nelems(); ++elem) {
+        Omega_h::Matrix<2, 3> vertex_coords;
+        for (int v = 0; v < 3; ++v) {
+          const auto vert = tris2verts[3 * elem + v];
+          vertex_coords[v] = Omega_h::Vector<2>{coords[2 * vert], coords[2 * vert + 1]};
+        }
+        if (pcms::triangle_intersects_bbox(vertex_coords, grid_h(0).GetCellBBOX(cell))) {
+          expected.push_back(elem);
+        }
+      }
+      std::vector<pcms::LO> actual(entries.data() + row_map(cell),
+                                   entries.data() + row_map(cell + 1));
+      REQUIRE(actual == expected);
+    }
+  }
 }
 TEST_CASE("uniform grid search") {
   using pcms::GridPointSearch;
@@ -199,13 +228,297 @@ TEST_CASE("uniform grid search") {
       REQUIRE(coords[2] == Catch::Approx(0.4));
     }
   }
-  // feature needs to be added
-  //SECTION("Global coordinate outisde mesh", "[!mayfail]") {
-  //  auto out_of_bounds = results_h(2);
-  //  auto top_left = results_h(3);
-  //  REQUIRE(-1*out_of_bounds.tri_id == top_left.tri_id);
-  //  out_of_bounds = results_h(4);
-  //  auto bot_left = results_h(0);
-  //  REQUIRE(-1*out_of_bounds.tri_id == bot_left.tri_id);
-  //}
+  SECTION("Global coordinate outisde mesh") {
+    auto out_of_bounds = results_h(2);
+    auto top_left = results_h(3);
+    REQUIRE(out_of_bounds.tri_id < 0);
+    REQUIRE(pcms::decode_outside_element(out_of_bounds.tri_id) == top_left.tri_id);
+    REQUIRE(out_of_bounds.parametric_coords[0] + out_of_bounds.parametric_coords[1] +
+              out_of_bounds.parametric_coords[2] == Catch::Approx(1));
+    out_of_bounds = results_h(4);
+    auto bot_left = results_h(0);
+    REQUIRE(out_of_bounds.tri_id < 0);
+    REQUIRE(pcms::decode_outside_element(out_of_bounds.tri_id) == bot_left.tri_id);
+    // closest point is the corner vertex of the element
+    REQUIRE(out_of_bounds.parametric_coords[0] == Catch::Approx(1));
+  }
+  SECTION("closest point")
+  {
+    Omega_h::Matrix<2, 3> coords{{0.0}, {1, 0}, {0.5, 1}};
+    auto xi = pcms::closest_point_barycentric({0.5, -1}, coords);
+    REQUIRE(xi[0] == Catch::Approx(0.5));
+    REQUIRE(xi[1] == Catch::Approx(0.5));
+    REQUIRE(xi[2] == Catch::Approx(0));
+    xi = pcms::closest_point_barycentric({0.5, 0.5}, coords);
+    REQUIRE(xi[0] == Catch::Approx(0.25));
+    REQUIRE(xi[1] == Catch::Approx(0.25));
+    REQUIRE(xi[2] == Catch::Approx(0.5));
+  }
+}
+TEST_CASE("closest element beyond the first non-empty ring")
+{
+  using pcms::GridPointSearch;
+  auto lib = Omega_h::Library{};
+  // a large triangle below the diagonal and a small triangle near the right
+  // edge. Seen from the top right corner the large triangle is in the first
+  // non-empty ring of grid cells, but the small triangle is closer and lies
+  // several rings further out
+  Omega_h::HostWrite<pcms::Real> coords_h(12);
+  const pcms::Real vertices[6][2] = {{0, 0},      {20, 0},  {0, 20},
+                                     {19.4, 6.0}, {19.6, 6}, {19.5, 6.9}};
+  for (int i = 0; i < 6; ++i) {
+    coords_h[2 * i] = vertices[i][0];
+    coords_h[2 * i + 1] = vertices[i][1];
+  }
+  Omega_h::HostWrite<pcms::LO> tris2verts_h(6);
+  for (int i = 0; i < 6; ++i) {
+    tris2verts_h[i] = i;
+  }
+  Omega_h::Mesh mesh(&lib);
+  Omega_h::build_from_elems_and_coords(&mesh, OMEGA_H_SIMPLEX, 2,
+                                       Omega_h::LOs(tris2verts_h.write()),
+                                       Omega_h::Reals(coords_h.write()));
+  GridPointSearch search{mesh, 20, 20};
+  Kokkos::View<pcms::Real*[2]> points("test_points", 1);
+  auto points_h = Kokkos::create_mirror_view(points);
+  points_h(0, 0) = 19.5;
+  points_h(0, 1) = 19.5;
+  Kokkos::deep_copy(points, points_h);
+  auto results =
+    Kokkos::create_mirror_view_and_copy(Kokkos::HostSpace{}, search(points));
+  REQUIRE(results(0).tri_id < 0);
+  REQUIRE(pcms::decode_outside_element(results(0).tri_id) == 1);
+  // closest point is the top vertex of the small triangle
+  REQUIRE(results(0).parametric_coords[2] == Catch::Approx(1));
+}
+TEST_CASE("adaptive grid resolution")
+{
+  using pcms::GridPointSearch;
+  auto lib = Omega_h::Library{};
+  auto world = lib.world();
+  SECTION("square mesh")
+  {
+    auto mesh =
+      Omega_h::build_box(world, OMEGA_H_SIMPLEX, 1, 1, 1, 40, 40, 0, false);
+    GridPointSearch search{mesh};
+    auto divisions = search.GetDivisions();
+    // 3200 elements with 4 elements per cell
+    REQUIRE(divisions[0] == 28);
+    REQUIRE(divisions[1] == 29);
+    const auto& stats = search.GetCandidateStatistics();
+    REQUIRE(stats.num_cells == 28 * 29);
+    REQUIRE(stats.num_empty_cells == 0);
+    REQUIRE(stats.min_candidates >= 1);
+    // each cell overlaps at most 3x3 squares of the structured mesh
+    REQUIRE(stats.max_candidates <= 18);
+    REQUIRE(stats.mean_candidates >= 4);
+  }
+  SECTION("elements per cell")
+  {
+    auto mesh =
+      Omega_h::build_box(world, OMEGA_H_SIMPLEX, 1, 1, 1, 40, 40, 0, false);
+    auto search = GridPointSearch::FromElementsPerCell(mesh, 32, true);
+    // 3200 elements with 32 elements per cell
+    REQUIRE(search.GetDivisions() == std::array<pcms::LO, 2>{10, 10});
+    REQUIRE(search.HasInverseBasisCache());
+  }
+  SECTION("aspect ratio")
+  {
+    auto divisions = pcms::detail::choose_grid_divisions({4, 1}, 400, 4);
+    REQUIRE(divisions[0] == 20);
+    REQUIRE(divisions[1] == 5);
+    divisions = pcms::detail::choose_grid_divisions({1, 0}, 10, 4);
+    REQUIRE(divisions[0] == 3);
+    REQUIRE(divisions[1] == 1);
+  }
+}
+TEST_CASE("bvh search")
+{
+  using pcms::BVHPointSearch;
+  using pcms::GridPointSearch;
+  auto lib = Omega_h::Library{};
+  auto world = lib.world();
+  auto mesh =
+    Omega_h::build_box(world, OMEGA_H_SIMPLEX, 1, 1, 1, 10, 10, 0, false);
+  BVHPointSearch bvh{mesh};
+  GridPointSearch grid{mesh, 10, 10};
+  constexpr int npoints = 7;
+  Kokkos::View<pcms::Real*[2]> points("test_points", npoints);
+  auto points_h = Kokkos::create_mirror_view(points);
+  const pcms::Real coords[npoints][2] = {{0, 0},      {0.55, 0.54}, {100, 100},
+                                         {1, 1},      {-1, -1},     {0.31, 0.77},
+                                         {0.5, 0.5}};
+  for (int i = 0; i < npoints; ++i) {
+    points_h(i, 0) = coords[i][0];
+    points_h(i, 1) = coords[i][1];
+  }
+  Kokkos::deep_copy(points, points_h);
+  auto bvh_results = Kokkos::create_mirror_view_and_copy(Kokkos::HostSpace{}, bvh(points));
+  auto grid_results = Kokkos::create_mirror_view_and_copy(Kokkos::HostSpace{}, grid(points));
+  for (int i = 0; i < npoints; ++i) {
+    REQUIRE(bvh_results(i).tri_id == grid_results(i).tri_id);
+    for (int j = 0; j < 3; ++j) {
+      REQUIRE(bvh_results(i).parametric_coords[j] ==
+              Catch::Approx(grid_results(i).parametric_coords[j]));
+    }
+  }
+  REQUIRE(bvh_results(1).tri_id == 91);
+  REQUIRE(bvh_results(2).tri_id < 0);
+  REQUIRE(bvh_results(4).tri_id < 0);
+  REQUIRE(pcms::decode_outside_element(bvh_results(4).tri_id) ==
+          bvh_results(0).tri_id);
+}
+TEST_CASE("walk search")
+{
+  using pcms::GridPointSearch;
+  auto lib = Omega_h::Library{};
+  auto world = lib.world();
+  auto mesh =
+    Omega_h::build_box(world, OMEGA_H_SIMPLEX, 1, 1, 1, 20, 20, 0, false);
+  GridPointSearch search{mesh, 5, 5};
+  // coherent sweep of points that don't lie on any mesh edge
+  constexpr int npoints_1d = 37;
+  constexpr int npoints = npoints_1d * npoints_1d;
+  Kokkos::View<pcms::Real*[2]> points("test_points", npoints);
+  auto points_h = Kokkos::create_mirror_view(points);
+  for (int i = 0; i < npoints_1d; ++i) {
+    for (int j = 0; j < npoints_1d; ++j) {
+      points_h(i * npoints_1d + j, 0) = (j + 0.31) / npoints_1d;
+      points_h(i * npoints_1d + j, 1) = (i + 0.43) / npoints_1d;
+    }
+  }
+  Kokkos::deep_copy(points, points_h);
+  auto scan_results =
+    Kokkos::create_mirror_view_and_copy(Kokkos::HostSpace{}, search(points));
+  search.SetQueryMode(GridPointSearch::QueryMode::Walk);
+  auto walk_results =
+    Kokkos::create_mirror_view_and_copy(Kokkos::HostSpace{}, search(points));
+  Kokkos::View<pcms::LO*> hints("hints", npoints);
+  Kokkos::deep_copy(hints, 0);
+  auto hint_results = Kokkos::create_mirror_view_and_copy(
+    Kokkos::HostSpace{}, search(points, hints));
+  for (int i = 0; i < npoints; ++i) {
+    REQUIRE(scan_results(i).tri_id >= 0);
+    REQUIRE(walk_results(i).tri_id == scan_results(i).tri_id);
+    REQUIRE(hint_results(i).tri_id == scan_results(i).tri_id);
+    for (int j = 0; j < 3; ++j) {
+      REQUIRE(walk_results(i).parametric_coords[j] ==
+              Catch::Approx(scan_results(i).parametric_coords[j]));
+    }
+  }
+}
+
+TEST_CASE("inverse basis cache")
+{
+  using pcms::GridPointSearch;
+  auto lib = Omega_h::Library{};
+  auto world = lib.world();
+  auto mesh =
+    Omega_h::build_box(world, OMEGA_H_SIMPLEX, 1, 1, 1, 20, 20, 0, false);
+  GridPointSearch search{mesh, 5, 5};
+  GridPointSearch cached_search{mesh, 5, 5, true};
+  REQUIRE(!search.HasInverseBasisCache());
+  REQUIRE(cached_search.HasInverseBasisCache());
+  // includes points outside of the mesh
+  constexpr int npoints_1d = 41;
+  constexpr int npoints = npoints_1d * npoints_1d;
+  Kokkos::View<pcms::Real*[2]> points("test_points", npoints);
+  auto points_h = Kokkos::create_mirror_view(points);
+  for (int i = 0; i < npoints_1d; ++i) {
+    for (int j = 0; j < npoints_1d; ++j) {
+      points_h(i * npoints_1d + j, 0) = (j + 0.31) / (npoints_1d - 4) - 0.05;
+      points_h(i * npoints_1d + j, 1) = (i + 0.43) / (npoints_1d - 4) - 0.05;
+    }
+  }
+  Kokkos::deep_copy(points, points_h);
+  for (auto mode :
+       {GridPointSearch::QueryMode::CandidateScan,
+        GridPointSearch::QueryMode::Walk}) {
+    search.SetQueryMode(mode);
+    cached_search.SetQueryMode(mode);
+    auto results =
+      Kokkos::create_mirror_view_and_copy(Kokkos::HostSpace{}, search(points));
+    auto cached_results = Kokkos::create_mirror_view_and_copy(
+      Kokkos::HostSpace{}, cached_search(points));
+    for (int i = 0; i < npoints; ++i) {
+      REQUIRE(cached_results(i).tri_id == results(i).tri_id);
+      for (int j = 0; j < 3; ++j) {
+        REQUIRE(cached_results(i).parametric_coords[j] ==
+                Catch::Approx(results(i).parametric_coords[j]).margin(1E-12));
+      }
+    }
+  }
+}
+
+TEST_CASE("vectorized scan")
+{
+  using pcms::GridPointSearch;
+  auto lib = Omega_h::Library{};
+  auto world = lib.world();
+  auto mesh =
+    Omega_h::build_box(world, OMEGA_H_SIMPLEX, 1, 1, 1, 20, 20, 0, false);
+  // coarse grid so the cells hold several blocks of candidates
+  GridPointSearch search{mesh, 3, 3};
+  constexpr int npoints_1d = 41;
+  constexpr int npoints = npoints_1d * npoints_1d;
+  Kokkos::View<pcms::Real*[2]> points("test_points", npoints);
+  auto points_h = Kokkos::create_mirror_view(points);
+  for (int i = 0; i < npoints_1d; ++i) {
+    for (int j = 0; j < npoints_1d; ++j) {
+      points_h(i * npoints_1d + j, 0) = (j + 0.31) / (npoints_1d - 4) - 0.05;
+      points_h(i * npoints_1d + j, 1) = (i + 0.43) / (npoints_1d - 4) - 0.05;
+    }
+  }
+  Kokkos::deep_copy(points, points_h);
+  auto scan_results =
+    Kokkos::create_mirror_view_and_copy(Kokkos::HostSpace{}, search(points));
+  search.SetQueryMode(GridPointSearch::QueryMode::VectorizedScan);
+  auto vectorized_results =
+    Kokkos::create_mirror_view_and_copy(Kokkos::HostSpace{}, search(points));
+  for (int i = 0; i < npoints; ++i) {
+    REQUIRE(vectorized_results(i).tri_id == scan_results(i).tri_id);
+    for (int j = 0; j < 3; ++j) {
+      REQUIRE(vectorized_results(i).parametric_coords[j] ==
+              Catch::Approx(scan_results(i).parametric_coords[j]).margin(1E-12));
+    }
+  }
+}
+
+TEST_CASE("sorted queries")
+{
+  using pcms::GridPointSearch;
+  auto lib = Omega_h::Library{};
+  auto world = lib.world();
+  auto mesh =
+    Omega_h::build_box(world, OMEGA_H_SIMPLEX, 1, 1, 1, 20, 20, 0, false);
+  GridPointSearch search{mesh, 8, 8};
+  // points in scrambled order, including some outside of the mesh
+  constexpr int npoints = 1000;
+  Kokkos::View<pcms::Real*[2]> points("test_points", npoints);
+  auto points_h = Kokkos::create_mirror_view(points);
+  for (int i = 0; i < npoints; ++i) {
+    const int k = (i * 389) % npoints;
+    points_h(i, 0) = (k % 37 + 0.31) / 33.0 - 0.05;
+    points_h(i, 1) = (k / 37 + 0.43) / 25.0 - 0.05;
+  }
+  Kokkos::deep_copy(points, points_h);
+  for (auto mode :
+       {GridPointSearch::QueryMode::CandidateScan,
+        GridPointSearch::QueryMode::VectorizedScan}) {
+    search.SetQueryMode(mode);
+    search.SetSortQueries(false);
+    auto results =
+      Kokkos::create_mirror_view_and_copy(Kokkos::HostSpace{}, search(points));
+    search.SetSortQueries(true);
+    REQUIRE(search.GetSortQueries());
+    auto sorted_results =
+      Kokkos::create_mirror_view_and_copy(Kokkos::HostSpace{}, search(points));
+    for (int i = 0; i < npoints; ++i) {
+      REQUIRE(sorted_results(i).tri_id == results(i).tri_id);
+      for (int j = 0; j < 3; ++j) {
+        REQUIRE(sorted_results(i).parametric_coords[j] ==
+                Catch::Approx(results(i).parametric_coords[j]));
+      }
+    }
+  }
 }
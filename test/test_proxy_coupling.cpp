@@ -25,25 +25,79 @@ using namespace std::chrono_literals;
 
 static constexpr bool done = true;
 static constexpr int COMM_ROUNDS = 4;
+// round in which the server defers deserialization of the delta_f gid fields
+// until the receive phase has ended
+static constexpr int DEFERRED_ROUND = 0;
+// round in which the delta_f gid fields are sent as a single message
+static constexpr int GROUPED_ROUND = 1;
+// rounds in which the server gathers the gid fields with GatherFields and
+// with the pipelined gather. Both must give the same combined field
+static constexpr int GATHER_ROUND = 2;
+static constexpr int PIPELINED_GATHER_ROUND = 3;
 namespace ts = test_support;
 
+// overwrite the received data so that the next check only passes if the data
+// was received again
+void reset_received_gids(Omega_h::Mesh& mesh, const std::string& tag_name)
+{
+  const Omega_h::Read<GO> invalid(mesh.nverts(), -1);
+  if (mesh.has_tag(0, tag_name)) {
+    mesh.set_tag(0, tag_name, invalid);
+  } else {
+    mesh.add_tag(0, tag_name, 1, invalid);
+  }
+}
+// the gids fields carry the global ids of the overlap vertices, so the
+// received data must match the global ids of the receiving mesh
+void check_received_gids(Omega_h::Mesh& mesh, const std::string& tag_name,
+                         Omega_h::Read<Omega_h::I8> mask)
+{
+  OmegaHField<GO, pcms::Real> field(tag_name, mesh, mask);
+  const auto received = Omega_h::HostRead<GO>(pcms::get_nodal_data(field));
+  const auto gids = Omega_h::HostRead<GO>(field.GetGids());
+  REDEV_ALWAYS_ASSERT(received.size() == gids.size());
+  for (int i = 0; i < received.size(); ++i) {
+    REDEV_ALWAYS_ASSERT(received[i] == gids[i]);
+  }
+}
+std::vector<pcms::Real> get_combined_gids(Omega_h::Mesh& mesh,
+                                          Omega_h::Read<Omega_h::I8> mask)
+{
+  OmegaHField<pcms::Real, pcms::Real> field("combined_gids", mesh, mask);
+  const auto combined =
+    Omega_h::HostRead<pcms::Real>(pcms::get_nodal_data(field));
+  return {combined.data(), combined.data() + combined.size()};
+}
+
 void xgc_delta_f(MPI_Comm comm, Omega_h::Mesh& mesh)
 {
   CouplerClient cpl("proxy_couple_xgc_delta_f", comm);
 
   auto is_overlap = ts::markOverlapMeshEntities(mesh, ts::IsModelEntInOverlap{});
+  // both fields are defined on the same vertices, so they share a layout
   cpl.AddField("gids",
-               OmegaHFieldAdapter<GO>("global", mesh, is_overlap));
+               OmegaHFieldAdapter<GO>("global", mesh, is_overlap), true,
+               "overlap");
   cpl.AddField("gids2",
-               OmegaHFieldAdapter<GO>("global", mesh, is_overlap));
+               OmegaHFieldAdapter<GO>("global", mesh, is_overlap), true,
+               "overlap");
+  const std::vector<std::string> gid_fields{"gids", "gids2"};
   do {
     for (int i = 0; i < COMM_ROUNDS; ++i) {
       cpl.BeginSendPhase();
-      cpl.SendField("gids");  //(Alt) df_gid_field->Send();
-      cpl.SendField("gids2"); //(Alt) df_gid_field->Send();
+      if (i == GROUPED_ROUND) {
+        cpl.SendFields(gid_fields);
+      } else {
+        cpl.SendField("gids");  //(Alt) df_gid_field->Send();
+        cpl.SendField("gids2"); //(Alt) df_gid_field->Send();
+      }
       cpl.EndSendPhase();
       cpl.BeginReceivePhase();
-      cpl.ReceiveField("gids"); //(Alt) df_gid_field->Receive();
+      if (i == GROUPED_ROUND) {
+        cpl.ReceiveFields(gid_fields);
+      } else {
+        cpl.ReceiveField("gids"); //(Alt) df_gid_field->Receive();
+      }
       cpl.EndReceivePhase();
       // cpl.ReceiveField("gids2"); //(Alt) df_gid_field->Receive();
     }
@@ -89,11 +143,13 @@ void xgc_coupler(MPI_Comm comm, Omega_h::Mesh& mesh, std::string_view cpn_file)
   auto* delta_f_gids = delta_f->AddField(
     "gids", OmegaHFieldAdapter<GO>("delta_f_gids", mesh, is_overlap),
     FieldTransferMethod::Copy, FieldEvaluationMethod::None,
-    FieldTransferMethod::Copy, FieldEvaluationMethod::None, is_overlap);
+    FieldTransferMethod::Copy, FieldEvaluationMethod::None, is_overlap,
+    "overlap");
   auto* delta_f_gids2 = delta_f->AddField(
     "gids2", OmegaHFieldAdapter<GO>("delta_f_gids2", mesh, is_overlap),
     FieldTransferMethod::Copy, FieldEvaluationMethod::None,
-    FieldTransferMethod::Copy, FieldEvaluationMethod::None, is_overlap);
+    FieldTransferMethod::Copy, FieldEvaluationMethod::None, is_overlap,
+    "overlap");
   // CombinerFunction is a functor that takes a vector of omega_h
   // fields combines their values and sets the combined values into the
   // resultant field
@@ -106,6 +162,8 @@ void xgc_coupler(MPI_Comm comm, Omega_h::Mesh& mesh, std::string_view cpn_file)
   // auto [gather, scatter] = cpl.AddSymmetricGatherScatterOp("cpl1",
   // {"total_f_gids", "delta_f_gids"},
   //                      "combined_gids", MeanCombiner{});
+  // combined field of the GATHER_ROUND
+  std::vector<pcms::Real> combined_gids;
   do {
     for (int i = 0; i < COMM_ROUNDS; ++i) {
       //  Gather OHField
@@ -114,21 +172,72 @@ void xgc_coupler(MPI_Comm comm, Omega_h::Mesh& mesh, std::string_view cpn_file)
       // 3. combine internal fields into combined internal field
       // gather->Run(); // alt cpl.GatherFields("cpl1")
       // gather->Run(); // alt cpl.GatherFields("cpl1")
-      total_f->ReceivePhase([&]() { total_f_gids->Receive(); });
-      delta_f->ReceivePhase([&]() {
-        delta_f_gids->Receive();
+      if (i == GATHER_ROUND) {
+        total_f->BeginReceivePhase();
+        delta_f->BeginReceivePhase();
+        cpl.GatherFields("cpl1");
         delta_f_gids2->Receive();
-      });
+        delta_f->EndReceivePhase();
+        total_f->EndReceivePhase();
+        combined_gids = get_combined_gids(mesh, is_overlap);
+      } else if (i == PIPELINED_GATHER_ROUND) {
+        mesh.set_tag(0, "combined_gids", Omega_h::Reals(mesh.nverts(), -1.0));
+        total_f->BeginReceivePhase();
+        delta_f->BeginReceivePhase();
+        cpl.BeginGatherFields("cpl1");
+        auto gids2_receive = delta_f->PostReceiveField("gids2");
+        // total_f is converted while the data of delta_f is transferred
+        total_f->EndReceivePhase();
+        cpl.ProgressGatherFields("cpl1", *total_f);
+        delta_f->EndReceivePhase();
+        cpl.ProgressGatherFields("cpl1", *delta_f);
+        cpl.EndGatherFields("cpl1");
+        gids2_receive.Complete();
+        REDEV_ALWAYS_ASSERT(get_combined_gids(mesh, is_overlap) ==
+                            combined_gids);
+      } else {
+        total_f->ReceivePhase([&]() { total_f_gids->Receive(); });
+        if (i == GROUPED_ROUND) {
+          reset_received_gids(mesh, "delta_f_gids");
+          reset_received_gids(mesh, "delta_f_gids2");
+          delta_f->ReceivePhase(
+            [&]() { delta_f->ReceiveFields({"gids", "gids2"}); });
+          check_received_gids(mesh, "delta_f_gids", is_overlap);
+          check_received_gids(mesh, "delta_f_gids2", is_overlap);
+        } else if (i == DEFERRED_ROUND) {
+          delta_f->BeginReceivePhase();
+          auto gids_receive = delta_f->PostReceiveField("gids");
+          auto gids2_receive = delta_f->PostReceiveField("gids2");
+          delta_f->EndReceivePhase();
+          reset_received_gids(mesh, "delta_f_gids");
+          reset_received_gids(mesh, "delta_f_gids2");
+          gids_receive.Complete();
+          gids2_receive.Complete();
+          check_received_gids(mesh, "delta_f_gids", is_overlap);
+          check_received_gids(mesh, "delta_f_gids2", is_overlap);
+        } else {
+          delta_f->ReceivePhase([&]() {
+            delta_f_gids->Receive();
+            delta_f_gids2->Receive();
+          });
+        }
+      }
       // Scatter OHField
       // 1. OHField transfer internal to native
       // 2. Send data to members
       // cpl.ScatterFields("cpl1"); // (Alt) scatter->Run();
       // scatter->Run(); // (Alt) cpl.ScatterFields("cpl1")
       total_f->SendPhase([&]() { total_f_gids->Send(); });
-      delta_f->SendPhase([&]() {
-        delta_f_gids->Send(pcms::Mode::Deferred);
-        delta_f_gids2->Send(pcms::Mode::Deferred);
-      });
+      if (i == GROUPED_ROUND) {
+        delta_f->SendPhase([&]() {
+          delta_f->SendFields({"gids", "gids2"}, pcms::Mode::Deferred);
+        });
+      } else {
+        delta_f->SendPhase([&]() {
+          delta_f_gids->Send(pcms::Mode::Deferred);
+          delta_f_gids2->Send(pcms::Mode::Deferred);
+        });
+      }
     }
   } while (!done);
   Omega_h::vtk::write_parallel("proxy_couple", &mesh, mesh.dim());
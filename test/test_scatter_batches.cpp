@@ -0,0 +1,122 @@
+#include <catch2/catch_test_macros.hpp>
+#include <Omega_h_mesh.hpp>
+#include <Omega_h_build.hpp>
+#include <Omega_h_for.hpp>
+#include <pcms/server.h>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace
+{
+using RealField = pcms::OmegaHField<pcms::Real, pcms::InternalCoordinateElement>;
+
+std::vector<std::reference_wrapper<pcms::InternalField>> as_refs(
+  std::vector<pcms::InternalField>& fields)
+{
+  return {fields.begin(), fields.end()};
+}
+
+Omega_h::HostRead<pcms::Real> host_data(const pcms::InternalField& field)
+{
+  return Omega_h::HostRead<pcms::Real>(
+    pcms::get_nodal_data(std::get<RealField>(field)));
+}
+} // namespace
+
+TEST_CASE("batched scatter matches unbatched scatter", "[scatter]")
+{
+  Omega_h::Library lib;
+  auto mesh =
+    Omega_h::build_box(lib.world(), OMEGA_H_SIMPLEX, 1, 1, 1, 10, 10, 0, false);
+  const auto nverts = mesh.nents(0);
+  Omega_h::Write<pcms::Real> combined_data(nverts);
+  Omega_h::parallel_for(
+    nverts, OMEGA_H_LAMBDA(int i) { combined_data[i] = 0.5 * i + 1; });
+  mesh.add_tag<pcms::Real>(0, "combined", 1, Omega_h::Read(combined_data));
+  pcms::InternalField combined{std::in_place_type<RealField>, "combined",
+                               mesh};
+
+  std::vector<pcms::InternalField> batched;
+  std::vector<pcms::InternalField> unbatched;
+  for (int i = 0; i < 3; ++i) {
+    batched.emplace_back(std::in_place_type<RealField>,
+                         "batched" + std::to_string(i), mesh);
+    unbatched.emplace_back(std::in_place_type<RealField>,
+                           "unbatched" + std::to_string(i), mesh);
+  }
+  auto batched_refs = as_refs(batched);
+  auto unbatched_refs = as_refs(unbatched);
+
+  const auto batches = pcms::detail::ConstructScatterBatches(batched_refs, true);
+  REQUIRE(batches.size() == 1);
+  REQUIRE(batches.front() == pcms::detail::ScatterBatch{0, 1, 2});
+  const auto single_batches =
+    pcms::detail::ConstructScatterBatches(unbatched_refs, false);
+  REQUIRE(single_batches.size() == 3);
+
+  for (const auto& batch : batches) {
+    pcms::detail::ScatterToBatch(combined, batched_refs, batch);
+  }
+  for (const auto& batch : single_batches) {
+    pcms::detail::ScatterToBatch(combined, unbatched_refs, batch);
+  }
+
+  const auto expected = host_data(combined);
+  for (size_t i = 0; i < batched.size(); ++i) {
+    const auto batched_data = host_data(batched[i]);
+    const auto unbatched_data = host_data(unbatched[i]);
+    REQUIRE(batched_data.size() == expected.size());
+    REQUIRE(unbatched_data.size() == expected.size());
+    for (int j = 0; j < expected.size(); ++j) {
+      REQUIRE(batched_data[j] == unbatched_data[j]);
+      REQUIRE(batched_data[j] == expected[j]);
+    }
+  }
+}
+
+TEST_CASE("scatter batches reject different vertex sets", "[scatter]")
+{
+  Omega_h::Library lib;
+  auto mesh =
+    Omega_h::build_box(lib.world(), OMEGA_H_SIMPLEX, 1, 1, 1, 10, 10, 0, false);
+  const auto nverts = mesh.nents(0);
+  Omega_h::Write<Omega_h::I8> even(nverts);
+  Omega_h::Write<Omega_h::I8> odd(nverts);
+  Omega_h::parallel_for(
+    nverts, OMEGA_H_LAMBDA(int i) {
+      even[i] = (i % 2 == 0);
+      odd[i] = (i % 2 == 1);
+    });
+  std::vector<pcms::InternalField> fields;
+  fields.emplace_back(std::in_place_type<RealField>, "even0", mesh,
+                      Omega_h::Read(even));
+  fields.emplace_back(std::in_place_type<RealField>, "odd", mesh,
+                      Omega_h::Read(odd));
+  fields.emplace_back(std::in_place_type<RealField>, "even1", mesh,
+                      Omega_h::Read(even));
+  fields.emplace_back(
+    std::in_place_type<
+      pcms::OmegaHField<Omega_h::I32, pcms::InternalCoordinateElement>>,
+    "even_int", mesh, Omega_h::Read(even));
+  auto refs = as_refs(fields);
+
+  REQUIRE(pcms::detail::IsSameVertexSet(fields[0], fields[2]));
+  REQUIRE_FALSE(pcms::detail::IsSameVertexSet(fields[0], fields[1]));
+  // same vertices but a different value type cannot share a batch
+  REQUIRE_FALSE(pcms::detail::IsSameVertexSet(fields[0], fields[3]));
+
+  REQUIRE(pcms::detail::IsValidScatterBatch(refs, {0, 2}));
+  REQUIRE_FALSE(pcms::detail::IsValidScatterBatch(refs, {0, 1}));
+  REQUIRE_FALSE(pcms::detail::IsValidScatterBatch(refs, {0, 2, 3}));
+  REQUIRE_FALSE(pcms::detail::IsValidScatterBatch(refs, {}));
+
+  const auto batches = pcms::detail::ConstructScatterBatches(refs, true);
+  REQUIRE(batches.size() == 3);
+  REQUIRE(batches[0] == pcms::detail::ScatterBatch{0, 2});
+  REQUIRE(batches[1] == pcms::detail::ScatterBatch{1});
+  REQUIRE(batches[2] == pcms::detail::ScatterBatch{3});
+  for (const auto& batch : batches) {
+    REQUIRE(pcms::detail::IsValidScatterBatch(refs, batch));
+  }
+}
@@ -269,7 +269,7 @@ struct MeanCombiner
       [&fields](auto&& combined_field) {
         using T = typename std::remove_reference_t<
           decltype(combined_field)>::value_type;
-        Omega_h::Write<T> combined_array(combined_field.Size());
+        Omega_h::Write<T> combined_array(combined_field.Size(), 0);
         for (auto& field_variant : fields) {
           std::visit(
             [&combined_array, &combined_field](auto&& field) {
@@ -43,6 +43,14 @@ TEST_CASE("uniform grid")
     REQUIRE(k == 11);
     REQUIRE(l == 9);
   }
+  SECTION("ClosestTwoDCellIndex") {
+    auto [i,j] = uniform_grid.ClosestTwoDCellIndex(Omega_h::Vector<2>{1.5, 0});
+    REQUIRE(i == 0);
+    REQUIRE(j == 1);
+    auto [k,l] = uniform_grid.ClosestTwoDCellIndex(Omega_h::Vector<2>{100, 100});
+    REQUIRE(k == 11);
+    REQUIRE(l == 9);
+  }
   SECTION("GetCellIndex") {
     REQUIRE(0 == uniform_grid.GetCellIndex(0,0));
     REQUIRE(119 == uniform_grid.GetCellIndex(11,9));
@@ -1,5 +1,6 @@
 #include <catch2/catch_test_macros.hpp>
 #include <catch2/catch_template_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
 #include <pcms/xgc_field_adapter.h>
 #include <algorithm>
 
@@ -129,3 +130,137 @@ TEMPLATE_TEST_CASE("XGC Field Adapter", "[adapter]", pcms::LO, pcms::Real)
   std::cerr<<"check data\n";
   REQUIRE(check_data(dummy_data, reverse_classification, in_overlap, 5) == 0);
 }
+
+TEST_CASE("XGC Field Adapter evaluation", "[adapter]")
+{
+  // vertices of a 10x10 lattice on the unit square
+  static constexpr auto n = 10;
+  static constexpr auto data_size = n * n;
+  std::vector<pcms::Real> coordinates(2 * data_size);
+  std::vector<pcms::Real> data(data_size);
+  const auto linear = [](pcms::Real x, pcms::Real y) { return 2 * x - y; };
+  for (int i = 0; i < data_size; ++i) {
+    coordinates[2 * i] = static_cast<pcms::Real>(i % n) / (n - 1);
+    coordinates[2 * i + 1] = static_cast<pcms::Real>(i / n) / (n - 1);
+    data[i] = linear(coordinates[2 * i], coordinates[2 * i + 1]);
+  }
+  const auto reverse_classification = create_dummy_rc(data_size);
+  XGCFieldAdapter<pcms::Real> field_adapter(
+    "fa", MPI_COMM_SELF, make_array_view(data), reverse_classification,
+    in_overlap, make_const_array_view(coordinates));
+  REQUIRE(field_adapter.HasCoordinates());
+  std::vector<pcms::Real> points{0.05, 0.05, 0.5, 0.5, 0.93, 0.31};
+  SECTION("moving least squares")
+  {
+    auto values = pcms::evaluate(field_adapter, pcms::MovingLeastSquares{},
+                                 make_const_array_view(points));
+    for (size_t i = 0; i < values.size(); ++i) {
+      REQUIRE(std::abs(values(i) - linear(points[2 * i], points[2 * i + 1])) <
+              1E-10);
+    }
+  }
+  SECTION("nearest neighbor")
+  {
+    auto values = pcms::evaluate(field_adapter, pcms::NearestNeighbor{},
+                                 make_const_array_view(points));
+    REQUIRE(values(0) == data[0]);
+    // (0.93, 0.31) is closest to lattice vertex (8, 3)
+    REQUIRE(values(2) == data[3 * n + 8]);
+  }
+  SECTION("cached operators")
+  {
+    REQUIRE(field_adapter.NumCachedOperators() == 0);
+    auto first = pcms::evaluate(field_adapter, pcms::MovingLeastSquares{},
+                                make_const_array_view(points));
+    // the second evaluation applies the cached operator to the new data
+    for (auto& value : data) {
+      value *= 2;
+    }
+    auto second = pcms::evaluate(field_adapter, pcms::MovingLeastSquares{},
+                                 make_const_array_view(points));
+    REQUIRE(field_adapter.NumCachedOperators() == 1);
+    for (size_t i = 0; i < second.size(); ++i) {
+      REQUIRE(std::abs(second(i) - 2 * first(i)) < 1E-10);
+    }
+    // a different number of neighbors gets its own operator
+    auto nearest = pcms::evaluate(field_adapter, pcms::NearestNeighbor{},
+                                  make_const_array_view(points));
+    REQUIRE(field_adapter.NumCachedOperators() == 2);
+    REQUIRE(nearest(0) == data[0]);
+    // new values at the same address rebuild the operator
+    points[0] = 0.95;
+    points[1] = 0.95;
+    auto moved = pcms::evaluate(field_adapter, pcms::NearestNeighbor{},
+                                make_const_array_view(points));
+    REQUIRE(field_adapter.NumCachedOperators() == 2);
+    REQUIRE(moved(0) == data[data_size - 1]);
+  }
+  SECTION("set nodal data")
+  {
+    std::vector<pcms::Real> new_data(data_size, 3.0);
+    pcms::set_nodal_data(field_adapter, make_const_array_view(new_data));
+    REQUIRE(std::all_of(data.begin(), data.end(),
+                        [](pcms::Real v) { return v == 3.0; }));
+  }
+}
+
+TEST_CASE("XGC Field Adapter in the default memory space", "[adapter]")
+{
+  using memory_space = Kokkos::DefaultExecutionSpace::memory_space;
+  static constexpr auto data_size = 100;
+  Kokkos::View<pcms::Real*, memory_space> data("data", data_size);
+  Kokkos::parallel_for(
+    Kokkos::RangePolicy<Kokkos::DefaultExecutionSpace>(0, data_size),
+    KOKKOS_LAMBDA(int i) { data(i) = i; });
+  const auto reverse_classification = create_dummy_rc(data_size);
+  XGCFieldAdapter<pcms::Real, pcms::Real, memory_space> field_adapter(
+    "fa", MPI_COMM_SELF, make_array_view(data), reverse_classification,
+    in_overlap);
+  std::vector<pcms::LO> permutation;
+  std::vector<pcms::Real> buffer(field_adapter.Serialize({}, {}));
+  field_adapter.Serialize(make_array_view(buffer),
+                          make_const_array_view(permutation));
+  REQUIRE(check_gids(buffer, data_size, reverse_classification, in_overlap) ==
+          0);
+  for (auto& val : buffer) {
+    val += 5;
+  }
+  field_adapter.Deserialize(make_const_array_view(buffer),
+                            make_const_array_view(permutation));
+  const auto data_h = Kokkos::create_mirror_view_and_copy(Kokkos::HostSpace{},
+                                                          data);
+  std::vector<pcms::Real> data_v(data_h.data(), data_h.data() + data_size);
+  REQUIRE(check_data(data_v, reverse_classification, in_overlap, 5) == 0);
+}
+
+// runs on all ranks of MPI_COMM_WORLD, which acts as the plane communicator.
+// Only the plane root serializes and receives data; the other ranks get it
+// through the plane distribution
+TEST_CASE("XGC Field Adapter plane distribution",
+          "[adapter][xgc plane distribution]")
+{
+  static constexpr auto data_size = 100;
+  std::vector<pcms::Real> data(data_size);
+  std::iota(data.begin(), data.end(), 0);
+  const auto reverse_classification = create_dummy_rc(data_size);
+  XGCFieldAdapter<pcms::Real> field_adapter("fa", MPI_COMM_WORLD,
+                                            make_array_view(data),
+                                            reverse_classification, in_overlap);
+  auto distribution = GENERATE(pcms::XGCPlaneDistribution::Broadcast,
+                               pcms::XGCPlaneDistribution::Overlap,
+                               pcms::XGCPlaneDistribution::SharedMemory);
+  field_adapter.SetPlaneDistribution(distribution);
+  REQUIRE(field_adapter.GetPlaneDistribution() == distribution);
+  std::vector<pcms::LO> permutation;
+  std::vector<pcms::Real> buffer(field_adapter.Serialize({}, {}));
+  field_adapter.Serialize(make_array_view(buffer),
+                          make_const_array_view(permutation));
+  for (int offset = 1; offset <= 2; ++offset) {
+    for (auto& val : buffer) {
+      val += 1;
+    }
+    field_adapter.Deserialize(make_const_array_view(buffer),
+                              make_const_array_view(permutation));
+    REQUIRE(check_data(data, reverse_classification, in_overlap, offset) == 0);
+  }
+}